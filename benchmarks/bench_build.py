@@ -0,0 +1,113 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+""" Build and run benchmark firmware under xsim """
+
+import os
+import re
+import shutil
+import sys
+
+BENCH_DIR = os.path.dirname(os.path.abspath(__file__))
+TESTS_DIR = os.path.join(BENCH_DIR, "..", "tests")
+sys.path.insert(0, TESTS_DIR)
+
+import Pyxsim  # noqa E402
+from helpers import get_usb_clk_phy  # noqa E402
+from usb_session import UsbSession  # noqa E402
+
+XN_FILES = {600: "test_xs3_600.xn", 800: "test_xs3_800.xn"}
+
+# xud, endpoint threads and dummy threads must fit on the tile
+MAX_THREADS = 8
+
+# Statements in the par of main() that are not endpoint threads
+NON_APP_THREADS = ("XUD_Main", "dummyThreads")
+
+
+def app_threads(app):
+    """Endpoint threads the firmware runs, counted from the top level statements
+    in the par of its main()"""
+    with open(os.path.join(BENCH_DIR, app, "src", "main.xc")) as f:
+        source = re.sub(r"//[^\n]*|/\*.*?\*/", "", f.read(), flags=re.S)
+
+    match = re.search(r"\bpar\s*{", source)
+    if match is None:
+        raise ValueError("{}: no par in main()".format(app))
+
+    # Top level statements up to the closing brace of the par
+    depth = 0
+    statements = [""]
+    for c in source[match.end() :]:
+        if depth == 0 and c == "}":
+            break
+        depth += {"(": 1, "{": 1, ")": -1, "}": -1}.get(c, 0)
+        if depth == 0 and c == ";":
+            statements.append("")
+        else:
+            statements[-1] += c
+
+    return len(
+        [
+            s
+            for s in statements
+            if s.strip() and not s.strip().startswith(NON_APP_THREADS)
+        ]
+    )
+
+
+def check_threads(app, core_freq, dummy_threads, bus_speed, check_mips=True):
+    """Returns a reason the configuration cannot run, or None"""
+    threads = 1 + app_threads(app) + dummy_threads
+
+    if threads > MAX_THREADS:
+        return "Too many threads"
+
+    # Same MIPS requirement as the tests
+    if check_mips and bus_speed == "HS" and core_freq / max(threads, 5) < 85.0:
+        return "HS requires 85 MIPS"
+
+    return None
+
+
+def build(app, core_freq, dummy_threads, bus_speed):
+    """Build the firmware, returns the binary path or None on failure"""
+    shutil.copy(
+        os.path.join(TESTS_DIR, "shared", XN_FILES[core_freq]),
+        os.path.join(BENCH_DIR, app, "src"),
+    )
+
+    build_options = [
+        "TEST_ARCH=xs3",
+        "TEST_FREQ={}".format(core_freq),
+        "TEST_DTHREADS={}".format(dummy_threads),
+        "TEST_EP_NUM=1",
+        "TEST_ADDRESS=0",
+        "TEST_BUS_SPEED={}".format(bus_speed),
+    ]
+
+    desc = "xs3_{}_{}_1_0_{}".format(core_freq, dummy_threads, bus_speed)
+    binary = "{app}/bin/{desc}/{app}_{desc}.xe".format(app=app, desc=desc)
+
+    success, _ = Pyxsim._build(
+        binary, do_clean=False, clean_only=False, build_options=build_options
+    )
+    return binary if success else None
+
+
+def run_events(binary, bus_speed, events, simargs=None):
+    """Simulate the binary with a session holding the events"""
+    session = UsbSession(bus_speed=bus_speed, run_enumeration=False, device_address=0)
+    for event in events:
+        session.add_event(event)
+
+    # Benchmark firmware runs forever, so end the simulation once the events
+    # have been driven
+    (clk, phy) = get_usb_clk_phy(
+        verbose=False,
+        do_timeout=False,
+        complete_fn=lambda phy: phy.xsi.terminate(),
+        arch="xs3",
+    )
+    phy.session = session
+
+    Pyxsim.run_on_simulator_(binary, simthreads=[clk, phy], simargs=simargs or [])
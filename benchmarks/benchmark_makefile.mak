@@ -0,0 +1,10 @@
+# Benchmarks are built as tests, with the test shared code and the benchmark
+# shared code. Only the paths that differ from the test build are set here.
+
+SHARED_CODE = ../../../tests/shared
+
+TEST_FLAGS += -I../../shared
+
+SOURCE_DIRS = ./src ../shared/src ../../tests/shared/src
+
+include ../../tests/test_makefile.mak
@@ -0,0 +1,154 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+""" IO loop cycle budget
+
+Parses an xsim instruction trace (--trace-to with --enable-fnop-tracing) and
+finds the worst case instruction count for each labelled path through
+XUD_LLD_IoLoop. Each path has a deadline in 60MHz UTMI clocks. Since a thread
+issues at most one instruction every max(threads, 5) core cycles, the worst
+case instruction count gives the time the path needs at a given core clock
+and thread count, and from that the slack against the deadline, the minimum
+core clock and the maximum thread count the path tolerates.
+
+Fnops are counted since they take an issue slot.
+"""
+
+import re
+
+from usb_packet import USB_DATA_VALID_COUNT
+from usb_phy import USB_PKT_TIMINGS
+
+UTMI_CLOCK_MHZ = 60
+
+MAX_THREADS = 8
+
+# Core cycles per instruction issue is never fewer than this
+MIN_ISSUE_THREADS = 5
+
+TURNAROUND = USB_PKT_TIMINGS["TX_TO_RX_PACKET_TIMEOUT"]
+
+# Path name: (start label, end label, deadline in USB clocks, deadline in bytes)
+# The deadline is the sum of the clocks and the time taken to transfer the
+# bytes at the bus speed. Bytes are used for paths that must keep pace with the
+# 32-bit port buffers whilst streaming data.
+PATHS = {
+    "Pid_In to PID out": ("Pid_In", "XUD_IN_Loop0", TURNAROUND, 0),
+    "Pid_In to NAK": ("Pid_In", "XUD_IN_TxNak", TURNAROUND, 0),
+    "IN data word": ("XUD_IN_TxLoop", "XUD_IN_TxLoop", 0, 4),
+    "IN tail to CRC out": ("XUD_IN_TxLoopEnd", "DoneTail", 0, 4),
+    "doRXData to first word": ("doRXData", "NextRxWord", 0, 4),
+    "RX data words": ("NextRxWord", "NextRxWord", 0, 36),
+    "RxALow to OUT ACK": ("RxALow", "doRXDataReturn_NonIso", TURNAROUND, 0),
+    "RxALow to SETUP ACK": ("RxALow", "XUD_Setup_SendSetupAck", TURNAROUND, 0),
+    "Pid_Ping to handshake": ("Pid_Ping", "NextTokenAfterPing", TURNAROUND, 0),
+}
+
+# Labels sharing an address, xsim may report either
+LABEL_ALIASES = {"Loop_BadPid": "NextTokenAfterPing"}
+
+# Reaching the token dispatch abandons any path in progress
+DISPATCH_LABELS = {"NextToken", "NextTokenAfterOut", "NextTokenAfterPing"}
+
+# tile[0]@1-... 00080104 (Pid_In              +   0) : ldc  r3, 0x10 @1234
+TRACE_LINE = re.compile(
+    r"^tile\[(?P<tile>\d+)\]@(?P<thread>\d+).*?"
+    r"\(\s*(?P<label>[\w.$]+)\s*\+\s*(?P<offset>\w+)\s*\)\s*:.*@(?P<cycle>\d+)\s*$"
+)
+
+
+def deadline_clocks(path, bus_speed):
+    _, _, clocks, nbytes = PATHS[path]
+    return clocks + nbytes * USB_DATA_VALID_COUNT[bus_speed]
+
+
+def parse_trace(lines):
+    """Returns {path: (max instructions, max elapsed core cycles, count)}"""
+
+    starts = {label for label, _, _, _ in PATHS.values()}
+    ends = {label for _, label, _, _ in PATHS.values()}
+
+    # Per thread: {path: (instruction count, start cycle)} for paths in progress
+    inProgress = {}
+    stats = {}
+
+    for line in lines:
+        m = TRACE_LINE.match(line)
+        if m is None:
+            continue
+
+        thread = (m.group("tile"), m.group("thread"))
+        label = LABEL_ALIASES.get(m.group("label"), m.group("label"))
+        entry = int(m.group("offset"), 16) == 0
+        cycle = int(m.group("cycle"))
+
+        paths = inProgress.get(thread)
+        if paths is None:
+            # Only follow the thread running the IO loop
+            if label != "XUD_LLD_IoLoop":
+                continue
+            paths = inProgress[thread] = {}
+
+        if entry and label in ends:
+            for name, (startLabel, endLabel, _, _) in PATHS.items():
+                if endLabel == label and name in paths:
+                    instrs, startCycle = paths.pop(name)
+                    maxInstrs, maxCycles, count = stats.get(name, (0, 0, 0))
+                    stats[name] = (
+                        max(maxInstrs, instrs),
+                        max(maxCycles, cycle - startCycle),
+                        count + 1,
+                    )
+
+        if entry and label in DISPATCH_LABELS:
+            paths.clear()
+
+        if entry and label in starts:
+            for name, (startLabel, _, _, _) in PATHS.items():
+                if startLabel == label:
+                    paths[name] = (0, cycle)
+
+        for name, (instrs, startCycle) in paths.items():
+            paths[name] = (instrs + 1, startCycle)
+
+    return stats
+
+
+def min_core_freq(instrs, deadline, threads):
+    """Lowest core clock (MHz) at which instrs issue within deadline clocks"""
+    return instrs * max(threads, MIN_ISSUE_THREADS) * UTMI_CLOCK_MHZ / deadline
+
+
+def max_threads(instrs, deadline, core_freq):
+    """Most threads at core_freq for which the path fits, 0 if none"""
+    for threads in range(MAX_THREADS, 0, -1):
+        if min_core_freq(instrs, deadline, threads) <= core_freq:
+            return threads
+    return 0
+
+
+def analyse(stats, core_freq, threads, bus_speed):
+    """Slack per path plus the clock and thread floors for the configuration"""
+    issue_ns = max(threads, MIN_ISSUE_THREADS) * 1000 / core_freq
+
+    paths = []
+    for name, (instrs, cycles, count) in stats.items():
+        deadline = deadline_clocks(name, bus_speed)
+        deadline_ns = deadline * 1000 / UTMI_CLOCK_MHZ
+        paths.append(
+            {
+                "path": name,
+                "count": count,
+                "instructions": instrs,
+                "elapsed_ns": cycles * 1000 / core_freq,
+                "deadline_ns": deadline_ns,
+                "slack_ns": deadline_ns - instrs * issue_ns,
+                "min_core_freq": min_core_freq(instrs, deadline, threads),
+                "max_threads": max_threads(instrs, deadline, core_freq),
+            }
+        )
+
+    return {
+        "paths": paths,
+        "min_core_freq": max((p["min_core_freq"] for p in paths), default=None),
+        "max_threads": min((p["max_threads"] for p in paths), default=None),
+    }
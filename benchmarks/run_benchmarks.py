@@ -0,0 +1,126 @@
+#!/usr/bin/env python
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+""" Run the throughput benchmarks
+
+Builds each benchmark firmware for every core frequency and dummy thread
+count requested, runs its host schedule under xsim and writes the results
+to a JSON report.
+"""
+
+import argparse
+import json
+import os
+
+from bench_build import BENCH_DIR, build, check_threads, run_events
+from usb_benchmark import Slot, UsbBenchmark
+
+PKT_LEN_BULK = {"HS": 512, "FS": 64}
+PKT_LEN_ISO = {"HS": 1024, "FS": 1023}
+
+# Max bulk packets per (micro)frame, USB 2.0 spec table 5-10
+BULK_PER_FRAME = {"HS": 13, "FS": 19}
+
+# Benchmark name: (firmware, schedule generator)
+BENCHMARKS = {
+    "bulk_out": (
+        "bench_rx",
+        lambda s: [Slot("OUT", 1, "BULK", PKT_LEN_BULK[s])] * BULK_PER_FRAME[s],
+    ),
+    "bulk_in": (
+        "bench_tx",
+        lambda s: [Slot("IN", 1, "BULK", PKT_LEN_BULK[s])] * BULK_PER_FRAME[s],
+    ),
+    "bulk_out_multi_ep": (
+        "bench_rx",
+        lambda s: [
+            Slot("OUT", 1 + (i % 2), "BULK", PKT_LEN_BULK[s])
+            for i in range(BULK_PER_FRAME[s])
+        ],
+    ),
+    "bulk_in_multi_ep": (
+        "bench_tx",
+        lambda s: [
+            Slot("IN", 1 + (i % 2), "BULK", PKT_LEN_BULK[s])
+            for i in range(BULK_PER_FRAME[s])
+        ],
+    ),
+    "bulk_loopback": (
+        "bench_loopback",
+        lambda s: [
+            Slot("OUT" if i % 2 == 0 else "IN", 1, "BULK", PKT_LEN_BULK[s])
+            for i in range(BULK_PER_FRAME[s] - 1)
+        ],
+    ),
+    # One ISO packet per (micro)frame, bulk in the remaining bandwidth
+    "iso_in_bulk_out": (
+        "bench_iso_bulk",
+        lambda s: [Slot("IN", 1, "ISO", PKT_LEN_ISO[s])]
+        + [Slot("OUT", 2, "BULK", PKT_LEN_BULK[s])] * (BULK_PER_FRAME[s] // 2),
+    ),
+}
+
+
+def run(name, core_freq, dummy_threads, bus_speed, frames):
+    app, schedule = BENCHMARKS[name]
+
+    result = {
+        "benchmark": name,
+        "firmware": app,
+        "core_freq": core_freq,
+        "dummy_threads": dummy_threads,
+        "bus_speed": bus_speed,
+    }
+
+    reason = check_threads(app, core_freq, dummy_threads, bus_speed)
+    if reason is not None:
+        result["skipped"] = reason
+        return result
+
+    binary = build(app, core_freq, dummy_threads, bus_speed)
+    if binary is None:
+        result["skipped"] = "Build failed"
+        return result
+
+    benchmark = UsbBenchmark(schedule(bus_speed), frames=frames)
+
+    run_events(binary, bus_speed, [benchmark])
+
+    result.update(benchmark.results)
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description="lib_xud throughput benchmarks")
+    parser.add_argument(
+        "--benchmark",
+        nargs="+",
+        choices=list(BENCHMARKS),
+        default=list(BENCHMARKS),
+    )
+    parser.add_argument("--core-freq", nargs="+", type=int, default=[600, 800])
+    parser.add_argument("--dummy-threads", nargs="+", type=int, default=[0, 3, 5])
+    parser.add_argument("--bus-speed", nargs="+", choices=["HS", "FS"], default=["HS"])
+    parser.add_argument(
+        "--frames", type=int, default=8, help="(Micro)frames to run per benchmark"
+    )
+    parser.add_argument("--output", default="benchmark_results.json")
+    args = parser.parse_args()
+
+    os.chdir(BENCH_DIR)
+
+    results = []
+    for name in args.benchmark:
+        for bus_speed in args.bus_speed:
+            for core_freq in args.core_freq:
+                for dummy_threads in args.dummy_threads:
+                    result = run(name, core_freq, dummy_threads, bus_speed, args.frames)
+                    print(json.dumps(result))
+                    results.append(result)
+
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=4)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,138 @@
+#!/usr/bin/env python
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+""" Run the IO loop cycle budget profiler
+
+Runs back-to-back traffic against each firmware under xsim with instruction
+tracing enabled, for every core frequency and dummy thread count requested.
+Reports the worst case instruction count and slack for each path through the
+IO loop, and the minimum core clock and maximum thread count the
+configuration tolerates, to a JSON report.
+"""
+
+import argparse
+import json
+import os
+
+from bench_build import BENCH_DIR, app_threads, build, check_threads, run_events
+from cycle_budget import analyse, parse_trace
+from usb_timing_margin import UsbTimingMargin
+
+# Firmware: transaction types run against it. IN to bench_rx exercises NAK
+WORKLOADS = {
+    "bench_tx": ["IN"],
+    "bench_rx": ["OUT", "PING", "IN"],
+    "bench_ctrl": ["SETUP"],
+}
+
+PKT_LEN = {"HS": 512, "FS": 64}
+
+
+def run(app, core_freq, dummy_threads, bus_speed, keep_trace):
+    result = {
+        "firmware": app,
+        "core_freq": core_freq,
+        "dummy_threads": dummy_threads,
+        "bus_speed": bus_speed,
+    }
+
+    # Note, configurations below the MIPS requirement are still profiled, the
+    # point is to find where the requirement really lies
+    reason = check_threads(app, core_freq, dummy_threads, bus_speed, check_mips=False)
+    if reason is not None:
+        result["skipped"] = reason
+        return result
+
+    binary = build(app, core_freq, dummy_threads, bus_speed)
+    if binary is None:
+        result["skipped"] = "Build failed"
+        return result
+
+    os.makedirs("logs", exist_ok=True)
+    trace = "logs/xsim_trace_{}_{}_{}_{}.txt".format(
+        app, core_freq, dummy_threads, bus_speed
+    )
+
+    events = []
+    for transType in WORKLOADS[app]:
+        if transType == "PING" and bus_speed != "HS":
+            continue
+        length = 8 if transType == "SETUP" else PKT_LEN[bus_speed]
+        events.append(UsbTimingMargin(transType, length, samples=4, max_gap=16))
+
+    run_events(
+        binary,
+        bus_speed,
+        events,
+        simargs=["--trace-to", trace, "--enable-fnop-tracing"],
+    )
+
+    with open(trace) as f:
+        stats = parse_trace(f)
+
+    if not keep_trace:
+        os.remove(trace)
+
+    threads = 1 + app_threads(app) + dummy_threads
+    result["threads"] = threads
+    result.update(analyse(stats, core_freq, threads, bus_speed))
+    return result
+
+
+ROW = "{:<12} {:>5} {:>3} {:<3} {:<24} {:>6} {:>9} {:>9} {:>7}"
+
+HEADER = ("firmware", "MHz", "thr", "bus", "path", "instrs", "slack_ns", "min_MHz")
+
+
+def print_table(results):
+    print(ROW.format(*HEADER, "max_thr"))
+    for result in results:
+        for path in result.get("paths", []):
+            print(
+                ROW.format(
+                    result["firmware"],
+                    result["core_freq"],
+                    result["threads"],
+                    result["bus_speed"],
+                    path["path"],
+                    path["instructions"],
+                    "{:.1f}".format(path["slack_ns"]),
+                    "{:.1f}".format(path["min_core_freq"]),
+                    path["max_threads"],
+                )
+            )
+
+
+def main():
+    parser = argparse.ArgumentParser(description="lib_xud IO loop cycle budget")
+    parser.add_argument(
+        "--firmware", nargs="+", choices=list(WORKLOADS), default=list(WORKLOADS)
+    )
+    parser.add_argument("--core-freq", nargs="+", type=int, default=[600, 800])
+    parser.add_argument("--dummy-threads", nargs="+", type=int, default=[0, 3, 5])
+    parser.add_argument("--bus-speed", nargs="+", choices=["HS", "FS"], default=["HS"])
+    parser.add_argument("--keep-traces", action="store_true")
+    parser.add_argument("--output", default="cycle_budget.json")
+    args = parser.parse_args()
+
+    os.chdir(BENCH_DIR)
+
+    results = []
+    for app in args.firmware:
+        for bus_speed in args.bus_speed:
+            for core_freq in args.core_freq:
+                for dummy_threads in args.dummy_threads:
+                    result = run(
+                        app, core_freq, dummy_threads, bus_speed, args.keep_traces
+                    )
+                    print(json.dumps(result))
+                    results.append(result)
+
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=4)
+
+    print_table(results)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,111 @@
+#!/usr/bin/env python
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+""" Run the round trip latency benchmarks
+
+Builds each echo firmware for every core frequency and dummy thread count
+requested, runs OUT then IN round trips under xsim and writes the latency
+distributions to a JSON report.
+"""
+
+import argparse
+import json
+import os
+
+from bench_build import BENCH_DIR, build, check_threads, run_events
+from usb_latency import FRAME_CLOCKS, UsbLatency
+
+# Client pattern: firmware
+CLIENTS = {
+    "blocking": "bench_echo",
+    "select": "bench_echo_select",
+}
+
+# Endpoint: (EP number, type, poll interval in (micro)frames whilst NAKed)
+# Bulk IN is polled back-to-back, interrupt IN once per (micro)frame as a
+# host would for bInterval 1
+ENDPOINTS = {
+    "bulk": (1, "BULK", 0),
+    "interrupt": (2, "INTERRUPT", 1),
+}
+
+
+def run(client, endpoint, core_freq, dummy_threads, bus_speed, length, iterations):
+    app = CLIENTS[client]
+    ep, epType, pollFrames = ENDPOINTS[endpoint]
+
+    result = {
+        "client": client,
+        "endpoint": endpoint,
+        "firmware": app,
+        "core_freq": core_freq,
+        "dummy_threads": dummy_threads,
+        "bus_speed": bus_speed,
+    }
+
+    reason = check_threads(app, core_freq, dummy_threads, bus_speed)
+    if reason is not None:
+        result["skipped"] = reason
+        return result
+
+    binary = build(app, core_freq, dummy_threads, bus_speed)
+    if binary is None:
+        result["skipped"] = "Build failed"
+        return result
+
+    latency = UsbLatency(
+        ep,
+        epType,
+        length,
+        iterations=iterations,
+        pollInterval=pollFrames * FRAME_CLOCKS[bus_speed],
+    )
+
+    run_events(binary, bus_speed, [latency])
+
+    result.update(latency.results)
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description="lib_xud round trip latency")
+    parser.add_argument(
+        "--client", nargs="+", choices=list(CLIENTS), default=list(CLIENTS)
+    )
+    parser.add_argument(
+        "--endpoint", nargs="+", choices=list(ENDPOINTS), default=list(ENDPOINTS)
+    )
+    parser.add_argument("--core-freq", nargs="+", type=int, default=[600, 800])
+    parser.add_argument("--dummy-threads", nargs="+", type=int, default=[0, 3, 5])
+    parser.add_argument("--bus-speed", nargs="+", choices=["HS", "FS"], default=["HS"])
+    parser.add_argument("--length", type=int, default=8, help="Payload in bytes")
+    parser.add_argument("--iterations", type=int, default=32)
+    parser.add_argument("--output", default="latency_results.json")
+    args = parser.parse_args()
+
+    os.chdir(BENCH_DIR)
+
+    results = []
+    for client in args.client:
+        for endpoint in args.endpoint:
+            for bus_speed in args.bus_speed:
+                for core_freq in args.core_freq:
+                    for dummy_threads in args.dummy_threads:
+                        result = run(
+                            client,
+                            endpoint,
+                            core_freq,
+                            dummy_threads,
+                            bus_speed,
+                            args.length,
+                            args.iterations,
+                        )
+                        print(json.dumps(result))
+                        results.append(result)
+
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=4)
+
+
+if __name__ == "__main__":
+    main()
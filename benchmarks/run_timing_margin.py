@@ -0,0 +1,131 @@
+#!/usr/bin/env python
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+""" Run the host timing margin sweep
+
+Builds the firmware for each transaction type for every core frequency and
+dummy thread count requested, measures DUT turnaround and the minimum host
+inter-packet gap under xsim, and writes the margin table to a JSON report.
+"""
+
+import argparse
+import json
+import os
+
+from bench_build import BENCH_DIR, build, check_threads, run_events
+from usb_timing_margin import TRANSACTION_TYPES, UsbTimingMargin
+
+PKT_LEN = {
+    "IN": {"HS": 512, "FS": 64},
+    "OUT": {"HS": 512, "FS": 64},
+    "PING": {"HS": 512, "FS": 64},
+    "SETUP": {"HS": 8, "FS": 8},
+    "ISO": {"HS": 1024, "FS": 1023},
+}
+
+COLUMNS = [
+    ("transaction", "{}"),
+    ("bus_speed", "{}"),
+    ("core_freq", "{}"),
+    ("dummy_threads", "{}"),
+    ("turnaround_max", "{}"),
+    ("turnaround_margin", "{}"),
+    ("min_gap", "{}"),
+    ("gap_margin", "{}"),
+]
+
+
+def run(transType, core_freq, dummy_threads, bus_speed, samples, burst):
+    app = TRANSACTION_TYPES[transType]
+
+    result = {
+        "transaction": transType,
+        "firmware": app,
+        "core_freq": core_freq,
+        "dummy_threads": dummy_threads,
+        "bus_speed": bus_speed,
+    }
+
+    # PING is high-speed only
+    if transType == "PING" and bus_speed != "HS":
+        result["skipped"] = "PING requires HS"
+        return result
+
+    reason = check_threads(app, core_freq, dummy_threads, bus_speed)
+    if reason is not None:
+        result["skipped"] = reason
+        return result
+
+    binary = build(app, core_freq, dummy_threads, bus_speed)
+    if binary is None:
+        result["skipped"] = "Build failed"
+        return result
+
+    margin = UsbTimingMargin(
+        transType, PKT_LEN[transType][bus_speed], samples=samples, burst=burst
+    )
+
+    run_events(binary, bus_speed, [margin])
+
+    result.update(margin.results)
+    return result
+
+
+def print_table(results):
+    print(" ".join("{:>17}".format(name) for name, _ in COLUMNS))
+    for result in results:
+        if "skipped" in result:
+            continue
+        print(
+            " ".join(
+                "{:>17}".format(fmt.format(result.get(name))) for name, fmt in COLUMNS
+            )
+        )
+
+
+def main():
+    parser = argparse.ArgumentParser(description="lib_xud host timing margins")
+    parser.add_argument(
+        "--transaction",
+        nargs="+",
+        choices=list(TRANSACTION_TYPES),
+        default=list(TRANSACTION_TYPES),
+    )
+    parser.add_argument("--core-freq", nargs="+", type=int, default=[600, 800])
+    parser.add_argument("--dummy-threads", nargs="+", type=int, default=[0, 3, 5])
+    parser.add_argument("--bus-speed", nargs="+", choices=["HS", "FS"], default=["HS"])
+    parser.add_argument(
+        "--samples", type=int, default=8, help="Transactions to measure turnaround"
+    )
+    parser.add_argument(
+        "--burst", type=int, default=4, help="Back-to-back transactions per gap step"
+    )
+    parser.add_argument("--output", default="timing_margin.json")
+    args = parser.parse_args()
+
+    os.chdir(BENCH_DIR)
+
+    results = []
+    for transType in args.transaction:
+        for bus_speed in args.bus_speed:
+            for core_freq in args.core_freq:
+                for dummy_threads in args.dummy_threads:
+                    result = run(
+                        transType,
+                        core_freq,
+                        dummy_threads,
+                        bus_speed,
+                        args.samples,
+                        args.burst,
+                    )
+                    print(json.dumps(result))
+                    results.append(result)
+
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=4)
+
+    print_table(results)
+
+
+if __name__ == "__main__":
+    main()
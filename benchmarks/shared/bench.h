@@ -0,0 +1,28 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _BENCH_H_
+#define _BENCH_H_
+#include "xud_shared.h"
+
+/* Max packet size used by the benchmark endpoints */
+#if (XUD_TEST_SPEED == 2)
+#define BENCH_BULK_PKT_LEN  (512)
+#define BENCH_ISO_PKT_LEN   (1024)
+#else
+#define BENCH_BULK_PKT_LEN  (64)
+#define BENCH_ISO_PKT_LEN   (1023)
+#endif
+
+/* Receive and discard packets forever */
+void BenchEp_Sink(chanend c_out);
+
+/* Send packets of the given length forever */
+void BenchEp_Source(chanend c_in, unsigned length);
+
+/* Receive and discard SETUP packets forever */
+void BenchEp_Setup(chanend c_out);
+
+/* Echo packets received on each OUT EP back on the matching IN EP, using select */
+void BenchEp_EchoSelect(chanend c_out1, chanend c_in1, chanend c_out2, chanend c_in2);
+
+#endif
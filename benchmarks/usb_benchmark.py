@@ -0,0 +1,146 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+""" Sustained throughput benchmark
+
+Drives a host (micro)frame schedule against the DUT for a number of frames
+and measures the achieved throughput. Each frame starts with an SOF and then
+works through the scheduled transactions. Like a real host controller, a
+NAKed transaction is retried later in the same frame if time allows.
+"""
+
+from collections import deque
+
+from usb_event import UsbEvent
+from usb_host import USB_EP_TYPE_ISO, UsbHost, UsbTransferError
+
+FS_PER_US = 1000 * 1000 * 1000
+
+FRAME_TIME_US = {"HS": 125, "FS": 1000}
+
+EP_TYPES = {"BULK": 0x02, "ISO": USB_EP_TYPE_ISO, "INTERRUPT": 0x03}
+
+
+class Slot:
+    """A transaction scheduled in every (micro)frame"""
+
+    def __init__(self, transType, ep, epType, length):
+        assert transType in ["IN", "OUT"]
+        assert epType in EP_TYPES
+        self.transType = transType
+        self.ep = ep
+        self.epType = epType
+        self.length = length
+
+
+class UsbBenchmark(UsbEvent):
+    def __init__(self, schedule, frames=8):
+        self._schedule = schedule
+        self._frames = frames
+
+        self.results = None
+
+        super().__init__()
+
+    @property
+    def event_count(self):
+        return 0
+
+    def expected_output(self, bus_speed, offset=0):
+        return ""
+
+    def __str__(self):
+        return "UsbBenchmark: {} slots, {} frames".format(
+            len(self._schedule), self._frames
+        )
+
+    def _transaction(self, host, slot, payload):
+        """Run a single transaction. Returns bytes transferred or None if NAKed"""
+
+        if slot.transType == "IN":
+            if slot.epType == "ISO":
+                pid, data = host.transaction_in(slot.ep)
+                return len(data) if data is not None else None
+
+            transfer = host.in_transfer(slot.ep, slot.length)
+        else:
+            transfer = host.out_transfer(slot.ep, payload[: slot.length])
+
+        try:
+            next(transfer)
+        except StopIteration as done:
+            if slot.transType == "IN":
+                return len(done.value)
+            return done.value
+
+        # Transfer yielded, the DUT NAKed
+        transfer.close()
+        return None
+
+    def drive(self, usb_phy, bus_speed):
+
+        host = UsbHost(usb_phy, bus_speed, quiet=True)
+
+        for slot in self._schedule:
+            if slot.transType == "IN":
+                host.maxPacketSize[slot.ep | 0x80] = slot.length
+                host.epType[slot.ep | 0x80] = EP_TYPES[slot.epType]
+            else:
+                host.maxPacketSize[slot.ep] = slot.length
+                host.epType[slot.ep] = EP_TYPES[slot.epType]
+
+        payload = [x & 0xFF for x in range(1024)]
+
+        frameTime = FRAME_TIME_US[bus_speed] * FS_PER_US
+        transactions = 0
+        naks = 0
+        timeouts = 0
+        bytesIn = 0
+        bytesOut = 0
+
+        start = usb_phy.xsi.get_time()
+
+        for frame in range(self._frames):
+            frameEnd = start + (frame + 1) * frameTime
+
+            host.sof(frame)
+
+            pending = deque(self._schedule)
+            while pending and usb_phy.xsi.get_time() < frameEnd:
+                slot = pending.popleft()
+                transactions += 1
+
+                try:
+                    length = self._transaction(host, slot, payload)
+                except UsbTransferError:
+                    timeouts += 1
+                    continue
+
+                if length is None:
+                    naks += 1
+
+                    # ISO is not retried
+                    if slot.epType != "ISO":
+                        pending.append(slot)
+                elif slot.transType == "IN":
+                    bytesIn += length
+                else:
+                    bytesOut += length
+
+            # Idle until the next SOF
+            if usb_phy.xsi.get_time() < frameEnd:
+                usb_phy.wait_until(frameEnd)
+
+        elapsed_us = (usb_phy.xsi.get_time() - start) / FS_PER_US
+
+        self.results = {
+            "bus_speed": bus_speed,
+            "frames": self._frames,
+            "elapsed_us": elapsed_us,
+            "bytes_in": bytesIn,
+            "bytes_out": bytesOut,
+            "throughput_mbps": (bytesIn + bytesOut) * 8 / elapsed_us,
+            "transactions": transactions,
+            "naks": naks,
+            "nak_ratio": naks / transactions if transactions else 0,
+            "timeouts": timeouts,
+        }
@@ -0,0 +1,170 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+""" Round trip latency benchmark
+
+Sends an OUT packet to an echo endpoint and immediately polls the matching IN
+endpoint until the data comes back, repeating for a number of iterations. The
+latency is measured from the first OUT token (including any NAKed attempts) to
+the echoed data being received, and reported as a distribution in USB clocks
+and in (micro)frames. An SOF is sent at the start of every (micro)frame, as a
+host would. Failed transfers are counted in the results rather than ending the
+run.
+"""
+
+import statistics
+
+from usb_event import UsbEvent
+from usb_host import UsbHost, UsbTransferError
+
+CLOCKS_PER_US = 60
+
+# USB clocks per (micro)frame
+FRAME_CLOCKS = {"HS": 125 * CLOCKS_PER_US, "FS": 1000 * CLOCKS_PER_US}
+
+# (Micro)frames per frame number
+FRAME_NUMBER_DIV = {"HS": 8, "FS": 1}
+
+# Idle between iterations (USB clocks)
+INTER_ITERATION_DELAY = 1000
+
+EP_TYPES = {"BULK": 0x02, "INTERRUPT": 0x03}
+
+
+class UsbLatency(UsbEvent):
+    def __init__(self, ep, epType, length, iterations=32, pollInterval=0):
+        assert epType in EP_TYPES
+        self._ep = ep
+        self._epType = epType
+        self._length = length
+        self._iterations = iterations
+
+        # USB clocks between IN polls whilst NAKed, 0 for back-to-back
+        self._pollInterval = pollInterval
+
+        self._usb_phy = None
+        self._bus_speed = None
+        self._host = None
+        self._frame = 0
+        self._nextSof = None
+        self._frameTime = None
+
+        self.results = None
+
+        super().__init__()
+
+    @property
+    def event_count(self):
+        return 0
+
+    def expected_output(self, bus_speed, offset=0):
+        return ""
+
+    def __str__(self):
+        return "UsbLatency: EP {} {}".format(self._ep, self._epType)
+
+    def _sof(self):
+        """Send an SOF if a (micro)frame boundary has been reached"""
+        if self._usb_phy.xsi.get_time() < self._nextSof:
+            return
+
+        frameNumber = (self._frame // FRAME_NUMBER_DIV[self._bus_speed]) & 0x7FF
+        self._host.sof(frameNumber)
+        self._frame += 1
+        self._nextSof += self._frameTime
+
+    def _wait_for_clocks(self, clocks):
+        """Idle for a number of clocks, sending any SOFs that fall due"""
+        period = self._usb_phy.clock.get_period_fs()
+        end = self._usb_phy.xsi.get_time() + clocks * period
+
+        while self._nextSof < end:
+            self._usb_phy.wait_until(self._nextSof)
+            self._sof()
+
+        remaining = int((end - self._usb_phy.xsi.get_time()) / period)
+        if remaining > 0:
+            self._usb_phy.wait_for_clocks(remaining)
+
+    def _complete(self, transfer, delay):
+        """Run a transfer, retrying after delay clocks whilst NAKed"""
+        while True:
+            self._sof()
+            try:
+                next(transfer)
+            except StopIteration as done:
+                return done.value
+            if delay:
+                self._wait_for_clocks(delay)
+
+    def drive(self, usb_phy, bus_speed):
+
+        host = UsbHost(usb_phy, bus_speed, quiet=True)
+        host.maxPacketSize[self._ep] = self._length
+        host.maxPacketSize[self._ep | 0x80] = self._length
+        host.epType[self._ep] = EP_TYPES[self._epType]
+        host.epType[self._ep | 0x80] = EP_TYPES[self._epType]
+
+        period_fs = usb_phy.clock.get_period_fs()
+
+        self._usb_phy = usb_phy
+        self._bus_speed = bus_speed
+        self._host = host
+        self._frameTime = FRAME_CLOCKS[bus_speed] * period_fs
+        self._nextSof = usb_phy.xsi.get_time()
+
+        latency = []
+        mismatches = 0
+        errors = []
+
+        for i in range(self._iterations):
+            payload = [(i + x) & 0xFF for x in range(self._length)]
+
+            start = usb_phy.xsi.get_time()
+
+            try:
+                self._complete(host.out_transfer(self._ep, payload), 0)
+                data = self._complete(
+                    host.in_transfer(self._ep, self._length), self._pollInterval
+                )
+            except UsbTransferError as e:
+                errors.append({"iteration": i, "status": e.status})
+            else:
+                latency.append(round((usb_phy.xsi.get_time() - start) / period_fs))
+
+                if data != payload:
+                    mismatches += 1
+
+            self._wait_for_clocks(INTER_ITERATION_DELAY)
+
+        self.results = {
+            "bus_speed": bus_speed,
+            "ep": self._ep,
+            "ep_type": self._epType,
+            "length": self._length,
+            "iterations": self._iterations,
+            "mismatches": mismatches,
+            "errors": errors,
+        }
+
+        if not latency:
+            return
+
+        frames = {}
+        for clocks in latency:
+            frame = clocks // FRAME_CLOCKS[bus_speed]
+            frames[frame] = frames.get(frame, 0) + 1
+
+        latency_sorted = sorted(latency)
+
+        self.results.update(
+            {
+                "latency_clocks_min": latency_sorted[0],
+                "latency_clocks_max": latency_sorted[-1],
+                "latency_clocks_mean": statistics.mean(latency),
+                "latency_clocks_median": statistics.median(latency),
+                "latency_clocks_p99": latency_sorted[int(0.99 * (len(latency) - 1))],
+                "latency_us_mean": statistics.mean(latency) / CLOCKS_PER_US,
+                "latency_frames_histogram": frames,
+                "latency_clocks": latency,
+            }
+        )
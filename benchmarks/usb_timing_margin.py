@@ -0,0 +1,143 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+""" Host timing margin measurement
+
+Measures, for one transaction type, how quickly the DUT responds to the host
+(turnaround, in USB clocks from the end of the host packet to TxValid) and
+binary searches the smallest host inter-packet gap at which back-to-back
+transactions still get a valid response. Both are compared against the values
+in USB_PKT_TIMINGS to give the remaining margin.
+"""
+
+from usb_event import UsbEvent
+from usb_host import USB_EP_TYPE_ISO, UsbHost, UsbTransferError
+from usb_packet import USB_PID
+from usb_phy import USB_PKT_TIMINGS
+
+# Transaction type: firmware to run it against
+TRANSACTION_TYPES = {
+    "IN": "bench_tx",
+    "OUT": "bench_rx",
+    "PING": "bench_rx",
+    "SETUP": "bench_ctrl",
+    "ISO": "bench_iso_bulk",
+}
+
+# Generous response timeout whilst measuring (USB clocks)
+MEASURE_TIMEOUT = 200
+
+# Idle time after a failed probe to let the DUT recover (USB clocks)
+RECOVERY_DELAY = 2000
+
+SETUP_DATA = [0x80, 0x06, 0x00, 0x01, 0x00, 0x00, 0x40, 0x00]
+
+
+class UsbTimingMargin(UsbEvent):
+    def __init__(self, transType, length, samples=8, burst=4, max_gap=64):
+        assert transType in TRANSACTION_TYPES
+        self._transType = transType
+        self._length = length
+        self._samples = samples
+        self._burst = burst
+        self._max_gap = max_gap
+
+        self.results = None
+
+        super().__init__()
+
+    @property
+    def event_count(self):
+        return 0
+
+    def expected_output(self, bus_speed, offset=0):
+        return ""
+
+    def __str__(self):
+        return "UsbTimingMargin: " + self._transType
+
+    def _transaction(self, host):
+        """Run one transaction, returns True if the DUT gave a valid response"""
+        transType = self._transType
+        try:
+            if transType == "IN":
+                pid, data = host.transaction_in(1)
+                return data is not None or pid == USB_PID["NAK"]
+
+            if transType == "ISO":
+                pid, data = host.transaction_in(1)
+                return data is not None
+
+            if transType == "OUT":
+                pid = host.data_pid(1, 0)
+                handshake = host.transaction_out("OUT", 1, pid, self._payload)
+                if handshake == USB_PID["ACK"]:
+                    host._toggle(1, 0)
+                return handshake in (USB_PID["ACK"], USB_PID["NAK"])
+
+            if transType == "PING":
+                return host.ping(1) in (USB_PID["ACK"], USB_PID["NAK"])
+
+            handshake = host.transaction_out("SETUP", 0, USB_PID["DATA0"], SETUP_DATA)
+            return handshake == USB_PID["ACK"]
+
+        except UsbTransferError:
+            return False
+
+    def _probe(self, host, gap):
+        """Burst of back-to-back transactions with the given host gap"""
+        host.interTransactionDelay = gap
+        for _ in range(self._burst):
+            if not self._transaction(host):
+                host.interTransactionDelay = RECOVERY_DELAY
+                self._transaction(host)
+                return False
+        return True
+
+    def drive(self, usb_phy, bus_speed):
+
+        host = UsbHost(usb_phy, bus_speed, quiet=True)
+        host.responseTimeout = MEASURE_TIMEOUT
+        host.maxPacketSize[1] = self._length
+        host.maxPacketSize[0x81] = self._length
+        if self._transType == "ISO":
+            host.epType[0x81] = USB_EP_TYPE_ISO
+
+        self._payload = [x & 0xFF for x in range(self._length)]
+
+        # Turnaround, measured with a relaxed host gap
+        host.interTransactionDelay = USB_PKT_TIMINGS["TX_TO_TX_PACKET_DELAY"]
+        turnaround = []
+        failures = 0
+        for _ in range(self._samples):
+            if self._transaction(host):
+                turnaround.append(host.responseClocks)
+            else:
+                failures += 1
+
+        # Smallest gap that still passes, assuming larger gaps always pass
+        lo = 0
+        hi = self._max_gap
+        if not self._probe(host, hi):
+            minGap = None
+        else:
+            while lo < hi:
+                mid = (lo + hi) // 2
+                if self._probe(host, mid):
+                    hi = mid
+                else:
+                    lo = mid + 1
+            minGap = lo
+
+        timeout = USB_PKT_TIMINGS["TX_TO_RX_PACKET_TIMEOUT"]
+        delay = USB_PKT_TIMINGS["TX_TO_TX_PACKET_DELAY"]
+
+        self.results = {
+            "transaction": self._transType,
+            "bus_speed": bus_speed,
+            "turnaround_min": min(turnaround) if turnaround else None,
+            "turnaround_max": max(turnaround) if turnaround else None,
+            "turnaround_failures": failures,
+            "turnaround_margin": timeout - max(turnaround) if turnaround else None,
+            "min_gap": minGap,
+            "gap_margin": delay - minGap if minGap is not None else None,
+        }
@@ -24,12 +24,132 @@
 #define XUD_STARTUP_ADDRESS (0)
 #endif
 
+/* Endpoint 0 max packet size used by XUD_DoGetRequest() until set from the device descriptor by
+ * USB_StandardRequests() (see XUD_SetEp0MaxPacketSize()) */
+#ifndef EP0_MAX_PACKET_SIZE
+#define EP0_MAX_PACKET_SIZE (64)
+#endif
+
+/* Drop XUD thread out of fast mode while waiting for tokens after a SOF. Fast mode is restored
+ * as soon as the next token PID is received. Frees issue slots for other threads on an idle bus */
+#ifndef XUD_IDLE_FAST_MODE_OFF
+#define XUD_IDLE_FAST_MODE_OFF (0)
+#endif
+
+/* Enable frame-batched ISO transfers (see XUD_SetReady_InBatch() and XUD_SetReady_OutBatch()) */
+#ifndef XUD_ISO_BATCH
+#define XUD_ISO_BATCH (0)
+#endif
+
+/* Maximum number of packets (microframes) described by a single ISO batch */
+#ifndef XUD_ISO_BATCH_MAX
+#define XUD_ISO_BATCH_MAX (8)
+#endif
+
+/* Number of IN endpoints (from EP 0) that may be armed against SOF with XUD_SetReady_InSof().
+ * XUD checks this many endpoints on every SOF. 0 disables the feature */
+#ifndef XUD_SOF_ARM_EP_COUNT
+#define XUD_SOF_ARM_EP_COUNT (0)
+#endif
+
+/* Record the reference timer at the end of every packet transferred on an endpoint,
+ * see XUD_GetTimestamp() */
+#ifndef XUD_EP_TIMESTAMPS
+#define XUD_EP_TIMESTAMPS (0)
+#endif
+
+/* Enable live USB telemetry over xSCOPE (see xud_telemetry.h). XUD counts NAKs and tracks SOF
+ * intervals, throughput is taken from the endpoint traffic tap */
+#ifndef XUD_TELEMETRY
+#define XUD_TELEMETRY (0)
+#endif
+
+/* Enable the endpoint traffic tap, XUD records a descriptor of every packet transferred on tapped
+ * endpoints for an observer task (see xud_tap.h) */
+#ifndef XUD_TAP
+#define XUD_TAP (XUD_TELEMETRY)
+#endif
+
+/* log2 of the number of descriptors buffered for the tap observer (1 to 8) */
+#ifndef XUD_TAP_ENTRIES_LOG2
+#define XUD_TAP_ENTRIES_LOG2 (4)
+#endif
+
+/* XUD owns a SETUP landing buffer per control endpoint: a valid SETUP is always ACKed, and if EP0 is
+ * not waiting in XUD_GetSetupBuffer() it is held for the next call. A newer SETUP replaces a held one */
+#ifndef XUD_SETUP_BUFFER
+#define XUD_SETUP_BUFFER (0)
+#endif
+
+/* log2 of the size (bytes) of each XUD owned SETUP buffer, must hold the data packet and CRC */
+#define XUD_SETUP_BUFFER_SHIFT (6)
+
+/* Shorten the boot to configured path: PHY bring-up is overlapped with endpoint setup and the
+ * minimum spec legal reset/chirp timings are used */
+#ifndef XUD_FAST_BOOT
+#define XUD_FAST_BOOT (0)
+#endif
+
+/* Record the reference timer at each stage of start up and resume from suspend, see
+ * XUD_GetBootProfile() and XUD_GetResumeProfile() */
+#ifndef XUD_PROFILE
+#define XUD_PROFILE (0)
+#endif
+
+/* Shorten the resume from suspend path: a reset seen whilst suspended is acted on after the minimum
+ * spec legal time rather than a fixed 2.5ms */
+#ifndef XUD_FAST_RESUME
+#define XUD_FAST_RESUME (0)
+#endif
+
+/* Tile clock divider (2 to 256) applied by XUD whilst the bus is suspended, the full tile clock is
+ * restored as soon as resume or reset signalling is seen. 0 leaves the tile clock untouched (XS3 only).
+ * Note, the divider slows every thread on the USB tile, not just XUD, for the whole of suspend */
+#ifndef XUD_SUSPEND_CLK_DIV
+#define XUD_SUSPEND_CLK_DIV (0)
+#endif
+
+/* Word offsets of the XUD_ep_info fields past array_ptr_setup (12). Fields belonging to an option only
+ * take space when it is enabled, so the offsets depend on the options built with */
+#define XUD_EP_INFO_SETUP_RX            (13)
+
+#if (XUD_ISO_BATCH)
+#define XUD_EP_INFO_BATCH               (XUD_EP_INFO_SETUP_RX + 1)
+#else
+#define XUD_EP_INFO_BATCH               (XUD_EP_INFO_SETUP_RX)
+#endif
+
+#if (XUD_SOF_ARM_EP_COUNT)
+#define XUD_EP_INFO_SOF_COUNT           (XUD_EP_INFO_BATCH + 1)
+#else
+#define XUD_EP_INFO_SOF_COUNT           (XUD_EP_INFO_BATCH)
+#endif
+
+#if (XUD_EP_TIMESTAMPS)
+#define XUD_EP_INFO_TIMESTAMP           (XUD_EP_INFO_SOF_COUNT + 1)
+#else
+#define XUD_EP_INFO_TIMESTAMP           (XUD_EP_INFO_SOF_COUNT)
+#endif
+
+#if (XUD_TAP)
+#define XUD_EP_INFO_TAP                 (XUD_EP_INFO_TIMESTAMP + 1)
+#else
+#define XUD_EP_INFO_TAP                 (XUD_EP_INFO_TIMESTAMP)
+#endif
+
+#if (XUD_SETUP_BUFFER)
+#define XUD_EP_INFO_SETUP_SEQ           (XUD_EP_INFO_TAP + 1)
+#define XUD_EP_INFO_SETUP_BUFFER        (XUD_EP_INFO_TAP + 2)
+#define XUD_EP_INFO_SETUP_SEQ_READ      (XUD_EP_INFO_TAP + 3)
+#endif
+
 #ifndef __ASSEMBLER__
 
 #include <xs1.h>
 #include <platform.h>
 #include <print.h>
 #include <xccompat.h>
+#include "XUD_USB_Defines.h"
 
 #ifndef XUD_WEAK_API
 #define XUD_WEAK_API       (0)
@@ -246,6 +366,73 @@ XUD_Result_t XUD_DoGetRequest(XUD_ep ep_out, XUD_ep ep_in,  unsigned char buffer
  **/
 XUD_Result_t XUD_DoSetRequestStatus(XUD_ep ep_in) ATTRIB_WEAK;
 
+/**
+ * \brief   Sets the Endpoint 0 max packet size used to split control data stages into packets.
+ *          USB_StandardRequests() sets this from ``bMaxPacketSize0`` of the device descriptor.
+ * \param   size        Max packet size in bytes (8, 16, 32 or 64)
+ * \return  XUD_RES_OKAY on success, XUD_RES_ERR if size is not a valid Endpoint 0 max packet size (the
+ *          current size is kept)
+ **/
+XUD_Result_t XUD_SetEp0MaxPacketSize(unsigned size);
+
+/**
+ * \brief   Returns the Endpoint 0 max packet size (see XUD_SetEp0MaxPacketSize()).
+ **/
+unsigned XUD_GetEp0MaxPacketSize(void);
+
+#ifndef __XC__
+/**
+ * \brief   Producer for XUD_DoGetRequestStream(). Writes up to one packet of the response.
+ * \param   user     User pointer passed to XUD_DoGetRequestStream().
+ * \param   offset   Offset of the packet in the response in bytes.
+ * \param   buffer   Buffer to write the packet into.
+ * \param   length   Bytes requested, at most the EP0 max packet size.
+ * \return  Bytes written. Fewer than requested ends the data stage early, more than requested is an
+ *          error (XUD_DoGetRequestStream() returns XUD_RES_ERR).
+ */
+typedef unsigned (*XUD_ControlProducer_t)(void *user, unsigned offset, unsigned char *buffer, unsigned length);
+
+/**
+ * \brief   Consumer for XUD_DoSetRequestStream(). Passed each packet of the data stage.
+ * \param   user     User pointer passed to XUD_DoSetRequestStream().
+ * \param   offset   Offset of the packet in the request data in bytes.
+ * \param   buffer   The received packet.
+ * \param   length   Length of the packet in bytes.
+ * \return  0 on success, non-zero to abandon the request.
+ */
+typedef int (*XUD_ControlConsumer_t)(void *user, unsigned offset, unsigned char *buffer, unsigned length);
+
+/**
+ * \brief   As XUD_DoGetRequest() but the response is generated a packet at a time by ``producer``,
+ *          such that only one packet is held in memory.
+ * \param   ep_out      The endpoint identifier that handles Endpoint 0 OUT data in the XUD manager.
+ * \param   ep_in       The endpoint identifier that handles Endpoint 0 IN data in the XUD manager.
+ * \param   length      Length of the response.
+ * \param   requested   The length that the host requested, (Typically pass the value ``wLength``).
+ * \param   producer    Called for each packet of the data stage.
+ * \param   user        Passed to producer.
+ * \return  XUD_RES_OKAY on success, XUD_RES_ERR if the producer returned more than it was asked for
+ *          (Endpoint 0 should then be STALLed), for other errors see `Status Reporting`_
+ */
+XUD_Result_t XUD_DoGetRequestStream(XUD_ep ep_out, XUD_ep ep_in, unsigned length, unsigned requested,
+    XUD_ControlProducer_t producer, void *user);
+
+/**
+ * \brief   Receives the data stage of a host to device control request a packet at a time, passing each
+ *          to ``consumer``, then performs the status stage.
+ * \param   ep_out      The endpoint identifier that handles Endpoint 0 OUT data in the XUD manager.
+ * \param   ep_in       The endpoint identifier that handles Endpoint 0 IN data in the XUD manager.
+ * \param   length      Length of the data stage (Typically pass the value ``wLength``).
+ * \param   consumer    Called for each packet of the data stage.
+ * \param   user        Passed to consumer.
+ * \return  XUD_RES_OKAY on success, XUD_RES_ERR if the consumer failed or the host sent too much
+ *          data or a packet larger than the EP0 max packet size (Endpoint 0 should then be STALLed),
+ *          for other errors see `Status Reporting`_
+ */
+XUD_Result_t XUD_DoSetRequestStream(XUD_ep ep_out, XUD_ep ep_in, unsigned length,
+    XUD_ControlConsumer_t consumer, void *user);
+#endif
+
 /**
  * \brief   This function will complete a reset on an endpoint. Can take
  *          one or two ``XUD_ep`` as parameters (the second parameter can be set to ``null``).
@@ -465,6 +652,259 @@ static inline XUD_Result_t XUD_SetReady_In(XUD_ep ep, unsigned char buffer[], in
     return XUD_SetReady_InPtr(ep, addr, len);
 }
 
+#if !(XUD_WEAK_API)
+/* Header-only fast path. Equivalent to XUD_GetBuffer()/XUD_SetBuffer() and XUD_GetData_Select()/
+ * XUD_SetData_Select() but inlined into the caller, avoiding the call overhead and the volatile
+ * accesses of the out-of-line implementations */
+
+/**
+ * \brief   Completes an OUT transfer previously started with XUD_SetReady_Out() or XUD_SetReady_OutPtr().
+ *          Pauses until data is available. Inline equivalent of XUD_GetData_Select().
+ * \param   ep          The OUT endpoint identifier (created by ``XUD_InitEp``).
+ * \param   datalength  The number of bytes written to the buffer.
+ * \return  XUD_RES_OKAY on success, XUD_RES_ERR if the packet was dropped due to a bad data PID
+ *          (endpoint must be marked ready again), for other errors see `Status Reporting`.
+ */
+static inline XUD_Result_t XUD_GetData_Inline(XUD_ep ep, REFERENCE_PARAM(unsigned, datalength))
+{
+    unsigned c;
+    unsigned isReset;
+    unsigned length;
+    unsigned lengthTail;
+    unsigned pid;
+    unsigned actualPid;
+    unsigned epType;
+    XUD_Result_t result = XUD_RES_OKAY;
+
+    asm volatile("ldw %0, %1[2]":"=r"(c):"r"(ep));
+
+    /* Wait for XUD response */
+    asm volatile("testct %0, res[%1]":"=r"(isReset):"r"(c));
+    if(isReset)
+    {
+        return XUD_RES_RST;
+    }
+
+    /* Packet length (words) and tail length (bits) */
+    asm volatile("in %0, res[%1]":"=r"(length):"r"(c));
+    asm volatile("int %0, res[%1]":"=r"(lengthTail):"r"(c));
+
+    asm volatile("ldw %0, %1[6]":"=r"(actualPid):"r"(ep));
+    asm volatile("ldw %0, %1[4]":"=r"(pid):"r"(ep));
+    asm volatile("ldw %0, %1[5]":"=r"(epType):"r"(ep));
+
+    /* Words and bits to bytes, -2 for CRC */
+    length = (length << 2) + (lengthTail >> 3) - 2;
+
+    if(actualPid != pid)
+    {
+        length = 0;
+        result = XUD_RES_ERR;
+    }
+    else if(epType != XUD_EPTYPE_ISO)
+    {
+#ifdef __XS2A__
+        pid ^= 0x8;
+#else
+        pid ^= 0x88;
+#endif
+        asm volatile("stw %0, %1[4]"::"r"(pid),"r"(ep));
+    }
+
+#ifdef __XC__
+    datalength = length;
+#else
+    *datalength = length;
+#endif
+    return result;
+}
+
+/**
+ * \brief   Completes an IN transfer previously started with XUD_SetReady_In() or XUD_SetReady_InPtr().
+ *          Pauses until the data has been sent. Inline equivalent of XUD_SetData_Select().
+ * \param   ep          The IN endpoint identifier (created by ``XUD_InitEp``).
+ * \return  XUD_RES_OKAY on success, for errors see `Status Reporting`.
+ */
+static inline XUD_Result_t XUD_SetData_Inline(XUD_ep ep)
+{
+    unsigned c;
+    unsigned isReset;
+    unsigned tmp;
+    unsigned pid;
+    unsigned epType;
+
+    asm volatile("ldw %0, %1[2]":"=r"(c):"r"(ep));
+
+    /* Wait for XUD response */
+    asm volatile("testct %0, res[%1]":"=r"(isReset):"r"(c));
+    if(isReset)
+    {
+        return XUD_RES_RST;
+    }
+
+    asm volatile("in %0, res[%1]":"=r"(tmp):"r"(c));
+
+    asm volatile("ldw %0, %1[4]":"=r"(pid):"r"(ep));
+    asm volatile("ldw %0, %1[5]":"=r"(epType):"r"(ep));
+
+    if(epType != XUD_EPTYPE_ISO)
+    {
+        pid ^= 0x88;
+        asm volatile("stw %0, %1[4]"::"r"(pid),"r"(ep));
+    }
+
+    return XUD_RES_OKAY;
+}
+
+/* Waits whilst endpoint is halted, returns XUD_RES_RST if a reset is pending */
+static inline XUD_Result_t XUD_WaitNotHalted_Inline(XUD_ep ep)
+{
+    unsigned reset;
+    unsigned halted;
+
+    do
+    {
+        asm volatile("ldw %0, %1[9]":"=r"(reset):"r"(ep));
+        if(reset)
+        {
+            return XUD_RES_RST;
+        }
+        asm volatile("ldw %0, %1[10]":"=r"(halted):"r"(ep));
+    }
+    while(halted == USB_PIDn_STALL);
+
+    return XUD_RES_OKAY;
+}
+
+/**
+ * \brief   Inline equivalent of XUD_GetBuffer().
+ * \param   ep          The OUT endpoint identifier (created by ``XUD_InitEp``).
+ * \param   buffer      The buffer in which to store data received from the host.
+ *                      The buffer is assumed to be word aligned.
+ * \param   datalength  The number of bytes written to the buffer.
+ * \return  XUD_RES_OKAY on success, for errors see `Status Reporting`.
+ */
+static inline XUD_Result_t XUD_GetBuffer_Inline(XUD_ep ep, unsigned char buffer[], REFERENCE_PARAM(unsigned, datalength))
+{
+    unsigned addr;
+    XUD_Result_t result;
+
+    asm volatile("mov %0, %1":"=r"(addr):"r"(buffer));
+
+    do
+    {
+        if(XUD_WaitNotHalted_Inline(ep) != XUD_RES_OKAY)
+        {
+            return XUD_RES_RST;
+        }
+
+        XUD_SetReady_OutPtr(ep, addr);
+
+        /* If error (e.g. bad PID seq) try again */
+        result = XUD_GetData_Inline(ep, datalength);
+    }
+    while(result == XUD_RES_ERR);
+
+    return result;
+}
+
+/**
+ * \brief   Inline equivalent of XUD_SetBuffer().
+ * \param   ep          The IN endpoint identifier (created by ``XUD_InitEp``).
+ * \param   buffer      The buffer of data to transmit to the host.
+ *                      The buffer is assumed be word aligned.
+ * \param   datalength  The number of bytes in the buffer.
+ * \return  XUD_RES_OKAY on success, for errors see `Status Reporting`.
+ */
+static inline XUD_Result_t XUD_SetBuffer_Inline(XUD_ep ep, unsigned char buffer[], unsigned datalength)
+{
+    unsigned addr;
+
+    asm volatile("mov %0, %1":"=r"(addr):"r"(buffer));
+
+    if(XUD_WaitNotHalted_Inline(ep) != XUD_RES_OKAY)
+    {
+        return XUD_RES_RST;
+    }
+
+    XUD_SetReady_InPtr(ep, addr, datalength);
+
+    return XUD_SetData_Inline(ep);
+}
+#endif
+
+#if (XUD_SOF_ARM_EP_COUNT)
+/**
+ * \brief   Prepares an IN endpoint to transmit data, marking it ready on a later SOF rather than
+ *          immediately. This allows data to be captured as late as possible before the host polls.
+ *          Completion is reported as per XUD_SetReady_In() e.g. via XUD_SetData_Select().
+ * \param   ep          The IN endpoint identifier (created by ``XUD_InitEp``). The endpoint number
+ *                      must be less than XUD_SOF_ARM_EP_COUNT.
+ * \param   buffer      The buffer to transmit to the host.
+ *                      The buffer is assumed be word aligned.
+ * \param   len         The length of the data to transmit.
+ * \param   sofCount    The endpoint is marked ready on receipt of the sofCount'th SOF (frame at FS,
+ *                      microframe at HS) from now. 0 marks the endpoint ready immediately.
+ * \return  XUD_RES_OKAY on success, XUD_RES_ERR if the endpoint is halted, for other errors see
+ *          `Status Reporting`. An endpoint halted whilst armed is sent once the halt is cleared.
+ */
+XUD_Result_t XUD_SetReady_InSof(XUD_ep ep, unsigned char buffer[], int len, unsigned sofCount);
+#endif
+
+#if (XUD_EP_TIMESTAMPS)
+/**
+ * \brief   Returns the reference timer value recorded by XUD at the end of the last packet
+ *          transferred on an endpoint. For OUT endpoints this is taken once the packet has been
+ *          received (after the handshake for non-ISO endpoints), for IN endpoints once the host
+ *          handshake has been received (after the data packet for ISO endpoints).
+ *          Valid once XUD_GetBuffer()/XUD_SetBuffer() (or select equivalent) has returned.
+ * \param   ep      The endpoint identifier (created by ``XUD_InitEp``).
+ * \return  Reference timer value (100MHz ticks)
+ */
+unsigned XUD_GetTimestamp(XUD_ep ep);
+#endif
+
+#if (XUD_PROFILE)
+/**
+ * \brief   Stages of XUD start up recorded in the boot profile, see XUD_GetBootProfile()
+ */
+typedef enum XUD_BootStage_t
+{
+    XUD_BOOT_MAIN = 0,      /**< XUD_Main() entered */
+    XUD_BOOT_EP_SETUP,      /**< Endpoint setup complete */
+    XUD_BOOT_USB_CLOCK,     /**< PHY enabled and USB clock running */
+    XUD_BOOT_BUS_RESET,     /**< Initial bus reset detected */
+    XUD_BOOT_SPEED,         /**< Speed negotiation complete, endpoints informed of bus speed */
+    XUD_BOOT_STAGE_COUNT
+} XUD_BootStage_t;
+
+/**
+ * \brief   Returns the reference timer value recorded at each stage of the most recent XUD start up.
+ *          Stages not yet reached read as 0. Typically used to measure time to enumeration.
+ * \param   times   Filled with the reference timer value (100MHz ticks) of each XUD_BootStage_t.
+ */
+void XUD_GetBootProfile(unsigned times[XUD_BOOT_STAGE_COUNT]);
+
+/**
+ * \brief   Stages of the most recent resume from suspend, see XUD_GetResumeProfile()
+ */
+typedef enum XUD_ResumeStage_t
+{
+    XUD_RESUME_K = 0,       /**< Resume K state seen on the bus */
+    XUD_RESUME_END,         /**< End of resume signalling, device back in its pre-suspend speed mode */
+    XUD_RESUME_IOLOOP,      /**< Packet processing restarted */
+    XUD_RESUME_STAGE_COUNT
+} XUD_ResumeStage_t;
+
+/**
+ * \brief   Returns the reference timer value recorded at each stage of the most recent resume from
+ *          suspend. Stages not yet reached read as 0. Endpoints keep their ready state over suspend so
+ *          the first transaction after XUD_RESUME_IOLOOP is serviced without the client re-arming.
+ * \param   times   Filled with the reference timer value (100MHz ticks) of each XUD_ResumeStage_t.
+ */
+void XUD_GetResumeProfile(unsigned times[XUD_RESUME_STAGE_COUNT]);
+#endif
+
 /**
  * \brief   Select handler function for receiving OUT endpoint data in a select.
  * \param   c        The chanend related to the endpoint
@@ -489,6 +929,146 @@ void XUD_GetData_Select(chanend c, XUD_ep ep, REFERENCE_PARAM(unsigned, length),
 #endif
 void XUD_SetData_Select(chanend c, XUD_ep ep, REFERENCE_PARAM(XUD_Result_t, result));
 
+/* Returned by XUD_SetReady_Setup() when a SETUP held by XUD (XUD_SETUP_BUFFER) has been copied into the buffer */
+#define XUD_SETUP_HELD          (1)
+
+/**
+ * \brief   Marks a control OUT endpoint as ready to receive a SETUP without waiting for it. Receipt is
+ *          then handled by XUD_GetSetup_Select(), allowing Endpoint 0 to wait on other events.
+ * \param   ep       The OUT endpoint identifier (created by ``XUD_InitEp``).
+ * \param   buffer   The buffer in which to store the SETUP data. The buffer is assumed to be word aligned.
+ * \return  XUD_RES_OKAY on success, XUD_SETUP_HELD if a held SETUP is already in buffer (no select event
+ *          follows), for errors see `Status Reporting`.
+ */
+int XUD_SetReady_Setup(XUD_ep ep, unsigned char buffer[]);
+
+/**
+ * \brief   Select handler function for receiving a SETUP in a select.
+ * \param   c        The chanend related to the endpoint
+ * \param   ep       The OUT endpoint identifier (created by ``XUD_InitEp``).
+ * \param   length   Passed by reference. The number of bytes written to the buffer (that was passed into
+ *                   XUD_SetReady_Setup())
+ * \param   result   XUD_Result_t passed by reference. XUD_RES_OKAY on success, for errors see `Status Reporting`.
+ */
+#ifdef __XC__
+#pragma select handler
+#endif
+void XUD_GetSetup_Select(chanend c, XUD_ep ep, REFERENCE_PARAM(unsigned, length), REFERENCE_PARAM(XUD_Result_t, result));
+
+/**
+ * \brief   Withdraws a SETUP ready made with XUD_SetReady_Setup(), such that Endpoint 0 can use the
+ *          chanend for a data or status stage. A SETUP that XUD had already started to receive is
+ *          waited for and returned.
+ * \param   c        The chanend related to the endpoint
+ * \param   ep       The OUT endpoint identifier (created by ``XUD_InitEp``).
+ * \param   length   Passed by reference. The number of bytes written to the buffer if a SETUP was received
+ * \param   result   XUD_Result_t passed by reference. Valid if a SETUP (or bus reset) was received
+ * \return  0 if the ready was withdrawn, 1 if a SETUP (or bus reset) was received instead
+ */
+int XUD_ClearReady_Setup(chanend c, XUD_ep ep, REFERENCE_PARAM(unsigned, length), REFERENCE_PARAM(XUD_Result_t, result));
+
+#if (XUD_ISO_BATCH)
+/* Per-packet entry of an ISO batch. Prepared by XUD_SetReady_InBatch()/XUD_SetReady_OutBatch()
+ * and updated by XUD as packets are transferred */
+typedef struct XUD_IsoBatchPacket_t
+{
+    unsigned buffer;                   // 0 Buffer (IN: end of buffer, OUT: start of landing slot)
+    int length;                        // 1 IN: negative word length, OUT: received length (words)
+    unsigned tail;                     // 2 Tail length (bits)
+} XUD_IsoBatchPacket_t;
+
+/* ISO batch descriptor. Must remain in scope until XUD has reported its completion */
+typedef struct XUD_IsoBatch_t
+{
+    unsigned end;                      // 0 Pointer past the last packet entry
+    unsigned cursor;                   // 1 Pointer to the current packet entry
+    unsigned next;                     // 2 Batch to continue with on completion, or 0. Cleared by XUD when it continues
+    unsigned count;                    // 3 Number of packets in the batch
+    XUD_IsoBatchPacket_t packets[XUD_ISO_BATCH_MAX];
+} XUD_IsoBatch_t;
+
+/**
+ * \brief      Marks an ISO IN endpoint as ready to transmit a batch of packets, one per ISO IN token.
+ *             If a batch is already in progress on the endpoint the new batch is queued behind it.
+ *             At most one batch may be queued.
+ * \param      ep          The IN endpoint identifier (created by ``XUD_InitEp``).
+ * \param      batch       The batch descriptor to use.
+ * \param      buffer      The packet data. Packet i starts at ``buffer[i * stride]``.
+ *                         The buffer is assumed to be word aligned.
+ * \param      stride      Distance in bytes between packets in buffer. Must be a multiple of 4.
+ * \param      lengths     The length in bytes of each packet.
+ * \param      count       The number of packets in the batch (1 to XUD_ISO_BATCH_MAX).
+ * \return     XUD_RES_OKAY on success, for errors see `Status Reporting`.
+ */
+XUD_Result_t XUD_SetReady_InBatch(XUD_ep ep, REFERENCE_PARAM(XUD_IsoBatch_t, batch),
+    unsigned char buffer[], unsigned stride, unsigned lengths[], unsigned count);
+
+/**
+ * \brief      Marks an ISO OUT endpoint as ready to receive a batch of packets, one per ISO OUT token.
+ *             If a batch is already in progress on the endpoint the new batch is queued behind it.
+ *             At most one batch may be queued.
+ * \param      ep          The OUT endpoint identifier (created by ``XUD_InitEp``).
+ * \param      batch       The batch descriptor to use.
+ * \param      buffer      The landing area. Packet i is stored at ``buffer[i * stride]``.
+ *                         The buffer is assumed to be word aligned.
+ * \param      stride      Distance in bytes between packets in buffer. Must be a multiple of 4
+ *                         and large enough for the packet plus its 2 byte CRC.
+ * \param      count       The number of packets in the batch (1 to XUD_ISO_BATCH_MAX).
+ * \return     XUD_RES_OKAY on success, for errors see `Status Reporting`.
+ */
+XUD_Result_t XUD_SetReady_OutBatch(XUD_ep ep, REFERENCE_PARAM(XUD_IsoBatch_t, batch),
+    unsigned char buffer[], unsigned stride, unsigned count);
+
+/**
+ * \brief      Transmits a batch of packets on an ISO IN endpoint, returning once all have been sent.
+ * \param      ep          The IN endpoint identifier (created by ``XUD_InitEp``).
+ * \param      batch       The batch descriptor to use.
+ * \param      buffer      The packet data, see XUD_SetReady_InBatch().
+ * \param      stride      Distance in bytes between packets in buffer.
+ * \param      lengths     The length in bytes of each packet.
+ * \param      count       The number of packets in the batch.
+ * \return     XUD_RES_OKAY on success, for errors see `Status Reporting`.
+ */
+XUD_Result_t XUD_SetBufferBatch(XUD_ep ep, REFERENCE_PARAM(XUD_IsoBatch_t, batch),
+    unsigned char buffer[], unsigned stride, unsigned lengths[], unsigned count);
+
+/**
+ * \brief      Receives a batch of packets on an ISO OUT endpoint, returning once all have been received.
+ * \param      ep          The OUT endpoint identifier (created by ``XUD_InitEp``).
+ * \param      batch       The batch descriptor to use.
+ * \param      buffer      The landing area, see XUD_SetReady_OutBatch().
+ * \param      stride      Distance in bytes between packets in buffer.
+ * \param      lengths     Array of count entries, filled with the length in bytes of each packet received.
+ * \param      count       The number of packets in the batch.
+ * \return     XUD_RES_OKAY on success, for errors see `Status Reporting`.
+ */
+XUD_Result_t XUD_GetBufferBatch(XUD_ep ep, REFERENCE_PARAM(XUD_IsoBatch_t, batch),
+    unsigned char buffer[], unsigned stride, unsigned lengths[], unsigned count);
+
+/**
+ * \brief   Select handler function for a completed ISO OUT batch.
+ * \param   c        The chanend related to the endpoint
+ * \param   ep       The OUT endpoint identifier (created by ``XUD_InitEp``).
+ * \param   lengths  Filled with the length in bytes of each packet in the completed batch.
+ * \param   result   Passed by reference. XUD_RES_OKAY on success, for errors see `Status Reporting`.
+ */
+#ifdef __XC__
+#pragma select handler
+#endif
+void XUD_GetBatch_Select(chanend c, XUD_ep ep, unsigned lengths[], REFERENCE_PARAM(XUD_Result_t, result));
+
+/**
+ * \brief   Select handler function for a completed ISO IN batch.
+ * \param   c        The chanend related to the endpoint
+ * \param   ep       The IN endpoint identifier (created by ``XUD_InitEp``).
+ * \param   result   Passed by reference. XUD_RES_OKAY on success, for errors see `Status Reporting`.
+ */
+#ifdef __XC__
+#pragma select handler
+#endif
+void XUD_SetBatch_Select(chanend c, XUD_ep ep, REFERENCE_PARAM(XUD_Result_t, result));
+#endif
+
 /* Control token defines - used to inform EPs of bus-state types */
 #define USB_RESET_TOKEN             8        /* Control token value that signals RESET */
 
@@ -514,6 +1094,25 @@ typedef struct XUD_ep_info
     unsigned int halted;               // 10 NAK or STALL
     unsigned int saved_array_ptr;      // 11
     unsigned int array_ptr_setup;      // 12
+    unsigned int setupRx;              // 13 Non-zero from XUD taking the SETUP ready at the token until the client is informed
+    /* Optional fields, see XUD_EP_INFO_* for offsets */
+#if (XUD_ISO_BATCH)
+    unsigned int batch;                // Active ISO batch (XUD_IsoBatch_t) or 0
+#endif
+#if (XUD_SOF_ARM_EP_COUNT)
+    unsigned int sofCount;             // SOFs remaining until EP marked ready (XUD_SetReady_InSof())
+#endif
+#if (XUD_EP_TIMESTAMPS)
+    unsigned int timestamp;            // Reference timer at end of last packet
+#endif
+#if (XUD_TAP)
+    unsigned int tap;                  // Non-zero if packets are mirrored to the tap observer
+#endif
+#if (XUD_SETUP_BUFFER)
+    unsigned int setupSeq;             // Count of SETUPs landed in the XUD owned buffer
+    unsigned int setupBuffer;          // XUD owned SETUP buffers (two, alternating) or 0 if not a control EP
+    unsigned int setupSeqRead;         // Value of setupSeq when client last took a SETUP
+#endif
 } XUD_ep_info;
 
 #endif
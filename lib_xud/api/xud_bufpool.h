@@ -0,0 +1,119 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+/*
+ * @brief      Reference counted packet buffer pool for zero-copy endpoint forwarding
+ */
+#ifndef _XUD_BUFPOOL_H_
+#define _XUD_BUFPOOL_H_
+
+#include "xud.h"
+
+/* Number of buffers in the pool (max 32). 0 disables the pool */
+#ifndef XUD_BUFPOOL_COUNT
+#define XUD_BUFPOOL_COUNT       (0)
+#endif
+
+/* Size (bytes) of each buffer in the pool. Must be a multiple of 4. Note, OUT packets are
+ * received along with their 2 byte CRC so buffers must be at least max packet size + 4 */
+#ifndef XUD_BUFPOOL_SIZE
+#define XUD_BUFPOOL_SIZE        (516)
+#endif
+
+/* Handle to a pool buffer. Handles are single words so may be passed between tasks (on the same tile)
+ * over channels. Ownership travels with the handle */
+typedef unsigned XUD_BufHandle_t;
+
+#define XUD_BUF_HANDLE_NONE     (0)
+
+#if (XUD_BUFPOOL_COUNT)
+/**
+ * \brief   Initialises the buffer pool, marking all buffers free. Must be called once before any other
+ *          buffer pool function is used.
+ * \return  XUD_RES_OKAY on success, XUD_RES_ERR if no hardware lock could be allocated. The pool
+ *          must not be used in this case.
+ */
+XUD_Result_t XUD_BufPool_Init(void);
+
+/**
+ * \brief   Allocates a buffer from the pool with a reference count of 1.
+ * \return  Handle to the buffer or XUD_BUF_HANDLE_NONE if the pool is empty. A caller must not
+ *          pass XUD_BUF_HANDLE_NONE on as a buffer; wait for a consumer to release one instead.
+ */
+XUD_BufHandle_t XUD_BufPool_Alloc(void);
+
+/**
+ * \brief   Adds a reference to a buffer e.g. before handing it to a second consumer.
+ * \param   h       Buffer handle. XUD_BUF_HANDLE_NONE is ignored.
+ */
+void XUD_BufPool_Retain(XUD_BufHandle_t h);
+
+/**
+ * \brief   Drops a reference to a buffer. The buffer is returned to the pool when no references remain.
+ * \param   h       Buffer handle. XUD_BUF_HANDLE_NONE is ignored.
+ * \return  XUD_RES_OKAY on success, XUD_RES_ERR if the buffer holds no references (e.g. a double
+ *          release), the pool is left unchanged.
+ */
+XUD_Result_t XUD_BufPool_Release(XUD_BufHandle_t h);
+
+/**
+ * \brief   Returns the (word aligned) address of the data of a buffer.
+ * \param   h       Buffer handle.
+ * \return  Buffer address, suitable for XUD_SetReady_OutPtr()/XUD_SetReady_InPtr().
+ */
+unsigned XUD_BufPool_Addr(XUD_BufHandle_t h);
+
+/**
+ * \brief   Returns the data length stored with a buffer.
+ * \param   h       Buffer handle.
+ * \return  Length in bytes.
+ */
+unsigned XUD_BufPool_GetLength(XUD_BufHandle_t h);
+
+/**
+ * \brief   Stores a data length with a buffer.
+ * \param   h       Buffer handle.
+ * \param   length  Length in bytes.
+ */
+void XUD_BufPool_SetLength(XUD_BufHandle_t h, unsigned length);
+
+/**
+ * \brief   Marks an OUT endpoint as ready to receive data into a pool buffer.
+ *          On completion (e.g. XUD_GetData_Select()) store the length with XUD_BufPool_SetLength().
+ * \param   ep      The OUT endpoint identifier (created by ``XUD_InitEp``).
+ * \param   h       Buffer handle.
+ * \return  XUD_RES_OKAY on success, XUD_RES_ERR if h is XUD_BUF_HANDLE_NONE, for other errors see
+ *          `Status Reporting`.
+ */
+XUD_Result_t XUD_SetReady_OutBuf(XUD_ep ep, XUD_BufHandle_t h);
+
+/**
+ * \brief   Marks an IN endpoint as ready to transmit the data held in a pool buffer, using the
+ *          length stored with the buffer.
+ * \param   ep      The IN endpoint identifier (created by ``XUD_InitEp``).
+ * \param   h       Buffer handle.
+ * \return  XUD_RES_OKAY on success, XUD_RES_ERR if h is XUD_BUF_HANDLE_NONE, for other errors see
+ *          `Status Reporting`.
+ */
+XUD_Result_t XUD_SetReady_InBuf(XUD_ep ep, XUD_BufHandle_t h);
+
+/**
+ * \brief   Receives data from an OUT endpoint into a pool buffer, storing the length with the buffer.
+ * \param   ep      The OUT endpoint identifier (created by ``XUD_InitEp``).
+ * \param   h       Buffer handle.
+ * \return  XUD_RES_OKAY on success, XUD_RES_ERR if h is XUD_BUF_HANDLE_NONE, for other errors see
+ *          `Status Reporting`.
+ */
+XUD_Result_t XUD_GetBufferHandle(XUD_ep ep, XUD_BufHandle_t h);
+
+/**
+ * \brief   Transmits the data held in a pool buffer on an IN endpoint. The caller keeps its
+ *          reference to the buffer.
+ * \param   ep      The IN endpoint identifier (created by ``XUD_InitEp``).
+ * \param   h       Buffer handle.
+ * \return  XUD_RES_OKAY on success, XUD_RES_ERR if h is XUD_BUF_HANDLE_NONE, for other errors see
+ *          `Status Reporting`.
+ */
+XUD_Result_t XUD_SetBufferHandle(XUD_ep ep, XUD_BufHandle_t h);
+#endif
+
+#endif
@@ -75,6 +75,25 @@ XUD_Result_t USB_StandardRequests(XUD_ep ep_out, XUD_ep ep_in,
     char * strDescs[],
 #endif
     int strDescsLength, REFERENCE_PARAM(USB_SetupPacket_t, sp), XUD_BusSpeed_t usbBusSpeed);
+/**
+  * \brief    Converts a string table, as passed to USB_StandardRequests(), into ready to send (UTF-16)
+  *           string descriptors. USB_StandardRequests() then serves string requests directly from the
+  *           converted descriptors rather than expanding the requested string on each request.
+  *
+  * \param    strDescs       String table. Entry 0 holds the LangIDs
+  * \param    strDescsLength Number of strings
+  * \param    buffer         Buffer to hold the descriptors, word aligned. Must remain valid whilst in use
+  * \param    bufferSize     Size of buffer in bytes. Each descriptor takes 2 bytes plus 2 per character,
+  *                          rounded up to a word, plus one word of index
+  *
+  * \return   Bytes of buffer used, or 0 if buffer is too small or a string exceeds 126 characters
+  */
+#ifdef __XC__
+unsigned USB_InitStringDescriptors(char * unsafe strDescs[], int strDescsLength, unsigned char buffer[], unsigned bufferSize);
+#else
+unsigned USB_InitStringDescriptors(char * strDescs[], int strDescsLength, unsigned char buffer[], unsigned bufferSize);
+#endif
+
 /**
  *  \brief  Receives a Setup data packet and parses it into the passed USB_SetupPacket_t structure.
  *  \param  ep_out   OUT endpint from XUD
@@ -84,4 +103,69 @@ XUD_Result_t USB_StandardRequests(XUD_ep ep_out, XUD_ep ep_in,
  */
 XUD_Result_t USB_GetSetupPacket(XUD_ep ep_out, XUD_ep ep_in, REFERENCE_PARAM(USB_SetupPacket_t, sp));
 
+/* Deferred control requests: Endpoint 0 hands a request to another task with USB_DeferRequest() and
+ * continues to wait for SETUPs (see XUD_SetReady_Setup()/XUD_GetSetup_Select()) alongside the response.
+ * The data (IN) or status stage is NAKed by XUD until the response is received and
+ * USB_DeferredRequestStages() called. One request may be outstanding per channel.
+ *
+ *      case c_defer :> XUD_Result_t status:
+ *          USB_GetDeferredResponse(c_defer, buffer, length);
+ *          if(!USB_DeferredRequestStages(c_ep0_out, ep0_out, ep0_in, sp, status, buffer, length, result))
+ *              XUD_SetReady_Setup(ep0_out, sbuffer);
+ */
+
+/**
+ *  \brief  Hands a control request to another task (Endpoint 0 side). The data stage of a host to device
+ *          request should be received first and passed in data.
+ *  \param  c_defer  Channel to the task completing the request
+ *  \param  sp       The request
+ *  \param  data     Data stage of a host to device request
+ *  \param  length   Length of data in bytes
+ */
+void USB_DeferRequest(chanend c_defer, REFERENCE_PARAM(USB_SetupPacket_t, sp), unsigned char data[], unsigned length);
+
+/**
+ *  \brief  Receives a deferred control request (completing task side).
+ *  \param  c_defer  Channel to Endpoint 0
+ *  \param  sp       SetupPacket structure to be filled in (passed by ref)
+ *  \param  data     Buffer for the data stage of a host to device request
+ *  \param  length   Passed by reference. Length of data in bytes
+ */
+void USB_GetDeferredRequest(chanend c_defer, REFERENCE_PARAM(USB_SetupPacket_t, sp), unsigned char data[], REFERENCE_PARAM(unsigned, length));
+
+/**
+ *  \brief  Completes a deferred control request (completing task side).
+ *  \param  c_defer  Channel to Endpoint 0
+ *  \param  data     Data stage of a device to host request
+ *  \param  length   Length of data in bytes
+ *  \param  status   XUD_RES_OKAY to complete the request, XUD_RES_ERR to STALL it
+ */
+void USB_CompleteDeferredRequest(chanend c_defer, unsigned char data[], unsigned length, XUD_Result_t status);
+
+/**
+ *  \brief  Receives the remainder of a deferred request response, after its status has been input
+ *          from c_defer (Endpoint 0 side).
+ *  \param  c_defer  Channel to the task completing the request
+ *  \param  data     Buffer for the data stage of a device to host request
+ *  \param  length   Passed by reference. Length of data in bytes
+ */
+void USB_GetDeferredResponse(chanend c_defer, unsigned char data[], REFERENCE_PARAM(unsigned, length));
+
+/**
+ *  \brief  Performs the data and/or status stage of a deferred request (Endpoint 0 side). Endpoint 0 must
+ *          have been marked ready for a SETUP with XUD_SetReady_Setup().
+ *  \param  c_ep_out Endpoint 0 OUT chanend
+ *  \param  ep_out   OUT endpoint from XUD (ep 0)
+ *  \param  ep_in    IN endpoint from XUD (ep 0)
+ *  \param  sp       The deferred request
+ *  \param  status   Response status from the completing task
+ *  \param  data     Response data
+ *  \param  length   Length of data in bytes
+ *  \param  result   Passed by reference. Result of the stages or, if superseded, of the SETUP receipt
+ *  \return          0 if the stages were performed, 1 if a SETUP (or bus reset) superseded the request. The
+ *                   SETUP is in the buffer passed to XUD_SetReady_Setup()
+ */
+int USB_DeferredRequestStages(chanend c_ep_out, XUD_ep ep_out, XUD_ep ep_in, REFERENCE_PARAM(USB_SetupPacket_t, sp),
+    XUD_Result_t status, unsigned char data[], unsigned length, REFERENCE_PARAM(XUD_Result_t, result));
+
 #endif
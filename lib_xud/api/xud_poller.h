@@ -0,0 +1,103 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+/*
+ * @brief      Single-thread multi-endpoint event poller for C applications
+ */
+#ifndef _XUD_POLLER_H_
+#define _XUD_POLLER_H_
+
+#include "xud.h"
+
+/* Maximum number of endpoints registered with a poller */
+#ifndef XUD_POLLER_MAX_EP
+#define XUD_POLLER_MAX_EP       (8)
+#endif
+
+#if !defined(__XC__) && !defined(__ASSEMBLER__)
+
+/**
+ * \brief   Endpoint completion callback.
+ *
+ *          For OUT endpoints ``*buffer``/``*length`` hold the received packet. For IN endpoints
+ *          ``*buffer``/``*length`` hold the packet just sent and should be updated with the next
+ *          packet to send. On XUD_RES_RST the endpoint has already been reset.
+ *
+ *          The callback may replace ``*buffer`` (and ``*length`` for IN) before returning.
+ *
+ * \param   user    User pointer passed to XUD_Poller_Add().
+ * \param   result  XUD_RES_OKAY on transfer completion or XUD_RES_RST on bus reset.
+ * \param   buffer  Endpoint buffer, passed by reference.
+ * \param   length  Packet length in bytes, passed by reference.
+ * \return  Non-zero to re-arm the endpoint with ``*buffer``/``*length``, 0 to leave it idle
+ *          (see XUD_Poller_Arm()).
+ */
+typedef int (*XUD_PollerCallback_t)(void *user, XUD_Result_t result, unsigned char **buffer, unsigned *length);
+
+typedef struct XUD_PollerEp_t
+{
+    XUD_ep ep;
+    unsigned isIn;
+    unsigned armed;
+    unsigned priority;
+    unsigned char *buffer;
+    unsigned length;
+    XUD_PollerCallback_t callback;
+    void *user;
+} XUD_PollerEp_t;
+
+typedef struct XUD_Poller_t
+{
+    unsigned count;
+    unsigned chanends[XUD_POLLER_MAX_EP];   /* Client chanends, in priority order */
+    XUD_PollerEp_t eps[XUD_POLLER_MAX_EP];  /* Endpoints, in priority order */
+} XUD_Poller_t;
+
+/**
+ * \brief   Initialises a poller with no endpoints registered.
+ * \param   poller  The poller.
+ */
+void XUD_Poller_Init(XUD_Poller_t *poller);
+
+/**
+ * \brief   Registers an endpoint with a poller and marks it ready with the buffer provided.
+ *          Control endpoint 0 is not supported.
+ * \param   poller      The poller.
+ * \param   ep          The endpoint identifier (created by ``XUD_InitEp``).
+ * \param   priority    Completions are dispatched in ascending priority order (0 first). Endpoints
+ *                      of equal priority are dispatched in registration order.
+ * \param   buffer      Initial buffer. If NULL the endpoint is registered idle.
+ * \param   length      Initial packet length in bytes (IN endpoints only).
+ * \param   callback    Completion callback.
+ * \param   user        Pointer passed to callback.
+ * \return  Index of endpoint in poller or -1 if the poller is full or ep is endpoint 0.
+ */
+int XUD_Poller_Add(XUD_Poller_t *poller, XUD_ep ep, unsigned priority, unsigned char *buffer, unsigned length,
+    XUD_PollerCallback_t callback, void *user);
+
+/**
+ * \brief   Marks an idle endpoint ready, e.g. after its callback returned 0.
+ * \param   poller  The poller.
+ * \param   ep      The endpoint identifier.
+ * \param   buffer  Buffer to receive into (OUT) or transmit from (IN).
+ * \param   length  Packet length in bytes (IN endpoints only).
+ * \return  XUD_RES_OKAY on success, for errors see `Status Reporting`.
+ */
+XUD_Result_t XUD_Poller_Arm(XUD_Poller_t *poller, XUD_ep ep, unsigned char *buffer, unsigned length);
+
+/**
+ * \brief   Waits (using a single event wait) for activity on any registered endpoint then
+ *          dispatches all pending completions in priority order, calling the endpoint callbacks
+ *          and re-arming endpoints as they request.
+ * \param   poller  The poller. At least one endpoint must be registered.
+ */
+void XUD_Poller_Poll(XUD_Poller_t *poller);
+
+/**
+ * \brief   Calls XUD_Poller_Poll() forever.
+ * \param   poller  The poller.
+ */
+void XUD_Poller_Run(XUD_Poller_t *poller);
+
+#endif
+
+#endif
@@ -0,0 +1,89 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+/*
+ * @brief      Endpoint proxy - exposes XUD endpoints to another tile over a single channel
+ */
+#ifndef _XUD_PROXY_H_
+#define _XUD_PROXY_H_
+
+#include "xud.h"
+
+/* Maximum number of OUT endpoints served by a proxy */
+#ifndef XUD_PROXY_MAX_EP_OUT
+#define XUD_PROXY_MAX_EP_OUT    (4)
+#endif
+
+/* Maximum number of IN endpoints served by a proxy */
+#ifndef XUD_PROXY_MAX_EP_IN
+#define XUD_PROXY_MAX_EP_IN     (4)
+#endif
+
+/* Packet buffers held by the proxy per endpoint. These are the credits available to the remote */
+#ifndef XUD_PROXY_SLOTS
+#define XUD_PROXY_SLOTS         (4)
+#endif
+
+/* Maximum packet size (bytes) of proxied endpoints. Must be a multiple of 4 */
+#ifndef XUD_PROXY_MAX_PKT
+#define XUD_PROXY_MAX_PKT       (512)
+#endif
+
+/* Commands sent from remote to proxy */
+#define XUD_PROXY_CMD_NONE      (0)
+#define XUD_PROXY_CMD_OUT       (1)
+#define XUD_PROXY_CMD_IN        (2)
+
+/**
+ * \brief   Endpoint proxy task. Must run on the same tile as XUD_Main(). Services a set of
+ *          endpoints, buffering packets locally, and exchanges them with a remote task (typically
+ *          on another tile) over a single channel in multi-packet blocks.
+ *
+ *          Flow control is credit based: OUT endpoints are only marked ready whilst the proxy has
+ *          a free packet buffer, so the host is NAKed once the remote falls behind. IN data is only
+ *          accepted from the remote against free proxy packet buffers.
+ *
+ *          Proxy endpoint indexes used by the remote API are the index into c_ep_out/c_ep_in.
+ *          Packet buffers are statically allocated, so only one proxy may run per tile.
+ *
+ * \param   c_ep_out    Array of OUT endpoint channels to proxy (as passed to XUD_Main()).
+ * \param   noEpOut     Number of OUT endpoints to proxy (max XUD_PROXY_MAX_EP_OUT).
+ * \param   c_ep_in     Array of IN endpoint channels to proxy (as passed to XUD_Main()).
+ * \param   noEpIn      Number of IN endpoints to proxy (max XUD_PROXY_MAX_EP_IN).
+ * \param   c_remote    Channel to remote task.
+ */
+void XUD_Proxy(chanend c_ep_out[], unsigned noEpOut, chanend c_ep_in[], unsigned noEpIn, chanend c_remote);
+
+/**
+ * \brief   Receives a block of packets from a proxied OUT endpoint. Waits until at least one packet
+ *          is available. May be run on any tile.
+ * \param   c_proxy     Channel connected to XUD_Proxy().
+ * \param   ep          Proxy OUT endpoint index.
+ * \param   buffer      Packet i is stored at ``buffer[i * XUD_PROXY_MAX_PKT]``.
+ *                      The buffer is assumed to be word aligned.
+ * \param   lengths     Filled with the length in bytes of each packet received.
+ * \param   maxPackets  The maximum number of packets to receive (max XUD_PROXY_SLOTS).
+ * \param   count       Passed by reference. The number of packets received.
+ * \return  XUD_RES_OKAY on success, XUD_RES_RST if the endpoint has been reset since the last call,
+ *          XUD_RES_ERR if ep is not a proxied OUT endpoint or a packet over XUD_PROXY_MAX_PKT was
+ *          received (truncated to XUD_PROXY_MAX_PKT).
+ */
+XUD_Result_t XUD_Proxy_GetBlock(chanend c_proxy, unsigned ep, unsigned char buffer[], unsigned lengths[],
+    unsigned maxPackets, REFERENCE_PARAM(unsigned, count));
+
+/**
+ * \brief   Transmits a block of packets on a proxied IN endpoint. Returns once all packets have been
+ *          accepted by the proxy, not once sent to the host. May be run on any tile.
+ * \param   c_proxy     Channel connected to XUD_Proxy().
+ * \param   ep          Proxy IN endpoint index.
+ * \param   buffer      Packet i is read from ``buffer[i * XUD_PROXY_MAX_PKT]``.
+ *                      The buffer is assumed to be word aligned.
+ * \param   lengths     The length in bytes of each packet.
+ * \param   count       The number of packets to transmit.
+ * \return  XUD_RES_OKAY on success, XUD_RES_RST if the endpoint has been reset since the last call,
+ *          XUD_RES_ERR if ep is not a proxied IN endpoint or a length is over XUD_PROXY_MAX_PKT
+ *          (nothing is sent).
+ */
+XUD_Result_t XUD_Proxy_SetBlock(chanend c_proxy, unsigned ep, unsigned char buffer[], unsigned lengths[],
+    unsigned count);
+
+#endif
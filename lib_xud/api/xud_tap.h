@@ -0,0 +1,52 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+/*
+ * @brief      Endpoint traffic tap - mirrors packet descriptors (and optionally payloads) of
+ *             selected endpoints to a low priority observer task. Enabled with XUD_TAP.
+ */
+#ifndef _XUD_TAP_H_
+#define _XUD_TAP_H_
+
+#include "xud.h"
+
+/* Descriptor of a packet transferred on a tapped endpoint */
+typedef struct XUD_TapDesc_t
+{
+    unsigned epAddress;                 // 0 EP address (IN endpoints have bit 7 set)
+    unsigned length;                    // 1 Packet length (bytes)
+    unsigned buffer;                    // 2 Address of packet data in the endpoint buffer
+    unsigned timestamp;                 // 3 Reference timer when transfer completed
+} XUD_TapDesc_t;
+
+#if (XUD_TAP)
+/**
+ * \brief   Selects whether packets on an endpoint are mirrored to the tap observer. May be called
+ *          before or after XUD_Main() is started.
+ * \param   epAddress   Endpoint address (bit 7 set for IN endpoints).
+ * \param   enable      Non-zero to tap the endpoint.
+ */
+void XUD_Tap_Enable(unsigned epAddress, unsigned enable);
+
+/**
+ * \brief   Takes the oldest descriptor recorded by XUD, if any. Does not block.
+ *
+ *          XUD never waits for the observer: whilst the descriptor buffer is full packets are not
+ *          recorded, see XUD_Tap_GetDropped().
+ *
+ * \param   desc        Passed by reference. Filled with the descriptor.
+ * \param   payload     Buffer to copy the packet payload to.
+ * \param   maxLength   Maximum number of payload bytes to copy, 0 for descriptors only. Payloads
+ *                      are copied from the endpoint buffer so may have been overwritten if the
+ *                      endpoint has since re-used the buffer.
+ * \return  1 if a descriptor was taken, 0 if none are available.
+ */
+int XUD_Tap_Read(REFERENCE_PARAM(XUD_TapDesc_t, desc), unsigned char payload[], unsigned maxLength);
+
+/**
+ * \brief   Returns the number of descriptors dropped because the observer fell behind.
+ * \return  Count of dropped descriptors since start up.
+ */
+unsigned XUD_Tap_GetDropped(void);
+#endif
+
+#endif
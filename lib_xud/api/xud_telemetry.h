@@ -0,0 +1,100 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+/*
+ * @brief      Live USB telemetry - periodically samples XUD state and streams it to the host over
+ *             xSCOPE probes. Enabled with XUD_TELEMETRY.
+ */
+#ifndef _XUD_TELEMETRY_H_
+#define _XUD_TELEMETRY_H_
+
+#include "xud.h"
+
+/* xSCOPE probe offsets from the probeBase passed to XUD_Telemetry(). Probes must be declared in the
+ * application config.xscope in this order */
+#define XUD_TELEMETRY_PROBE_SPEED       (0)     /* Bus speed (XUD_BusSpeed_t) */
+#define XUD_TELEMETRY_PROBE_READY       (1)     /* Number of endpoints marked ready */
+#define XUD_TELEMETRY_PROBE_SOF_JITTER  (2)     /* Max minus min SOF interval in the period (ref clock ticks) */
+#define XUD_TELEMETRY_PROBE_DROPPED     (3)     /* Packets not counted because the telemetry task fell behind */
+#define XUD_TELEMETRY_PROBE_EP          (4)     /* Per endpoint: bytes in the period, then NAKs per 1000 tokens */
+
+/* One telemetry sample, the values XUD_Telemetry() writes to the probes each period */
+typedef struct XUD_TelemetrySample_t
+{
+    unsigned speed;                             // Bus speed (XUD_BusSpeed_t)
+    unsigned readyCount;                        // Number of endpoints marked ready
+    unsigned sofIntervalMin;                    // Min SOF interval in the period (ref clock ticks), 0xFFFFFFFF if none
+    unsigned sofIntervalMax;                    // Max SOF interval in the period (ref clock ticks), 0 if none
+    unsigned dropped;                           // Packets not counted because the observer fell behind
+    unsigned bytes[USB_MAX_NUM_EP];             // Per endpoint: bytes in the period
+    unsigned packets[USB_MAX_NUM_EP];           // Per endpoint: packets in the period
+    unsigned naks[USB_MAX_NUM_EP];              // Per endpoint: NAKs in the period
+} XUD_TelemetrySample_t;
+
+/* Sampling state, see XUD_Telemetry_Init() */
+typedef struct XUD_Telemetry_t
+{
+    unsigned period;
+    unsigned sampleTime;
+    unsigned epAddresses[USB_MAX_NUM_EP];
+    unsigned epCount;
+    unsigned lastNaks[USB_MAX_NUM_EP];
+    unsigned lastDropped;
+    unsigned timer;                             // Hardware timer the sampler waits on
+} XUD_Telemetry_t;
+
+#if (XUD_TELEMETRY)
+/**
+ * \brief   Prepares for sampling with XUD_Telemetry_Sample() and enables the tap on each endpoint.
+ *          A hardware timer is allocated, release it with XUD_Telemetry_Free().
+ *
+ * \param   telemetry       Passed by reference. Sampling state.
+ * \param   period_us       Sample period (microseconds).
+ * \param   epAddresses     Endpoint addresses to report (bit 7 set for IN endpoints).
+ * \param   epCount         Number of entries in epAddresses, at most USB_MAX_NUM_EP.
+ * \return  XUD_RES_OKAY on success, XUD_RES_ERR if epCount is over USB_MAX_NUM_EP or no hardware
+ *          timer is free.
+ */
+XUD_Result_t XUD_Telemetry_Init(REFERENCE_PARAM(XUD_Telemetry_t, telemetry), unsigned period_us,
+                        unsigned epAddresses[], unsigned epCount);
+
+/**
+ * \brief   Waits for the end of the current period, counting tapped packets as they arrive, then
+ *          takes a sample. Blocks on a timer between checks of the tap, so the observer thread only
+ *          issues whilst there is work to do.
+ *
+ * \param   telemetry       Passed by reference. Sampling state from XUD_Telemetry_Init().
+ * \param   sample          Passed by reference. Filled with the sample for the period, per endpoint
+ *                          values are in epAddresses order.
+ */
+void XUD_Telemetry_Sample(REFERENCE_PARAM(XUD_Telemetry_t, telemetry),
+                          REFERENCE_PARAM(XUD_TelemetrySample_t, sample));
+
+/**
+ * \brief   Releases the hardware timer allocated by XUD_Telemetry_Init().
+ *
+ * \param   telemetry       Passed by reference. Sampling state from XUD_Telemetry_Init().
+ */
+void XUD_Telemetry_Free(REFERENCE_PARAM(XUD_Telemetry_t, telemetry));
+
+/**
+ * \brief   Telemetry task, does not return unless XUD_Telemetry_Init() fails. Samples XUD state
+ *          every period and writes it to xSCOPE probes, see XUD_TELEMETRY_PROBE_*.
+ *
+ *          Endpoint throughput is taken from the endpoint traffic tap (xud_tap.h), this task is the
+ *          tap observer. The XUD thread only counts NAKs and tracks SOF intervals, so the cost to the
+ *          USB thread is a few instructions per NAK and SOF.
+ *
+ *          For each endpoint in epAddresses two probes are written, from
+ *          probeBase + XUD_TELEMETRY_PROBE_EP + (2 * index).
+ *
+ *          Equivalent to XUD_Telemetry_Init() then XUD_Telemetry_Sample() each period.
+ *
+ * \param   period_us       Sample period (microseconds).
+ * \param   probeBase       xSCOPE probe ID of the first telemetry probe.
+ * \param   epAddresses     Endpoint addresses to report (bit 7 set for IN endpoints).
+ * \param   epCount         Number of entries in epAddresses, at most USB_MAX_NUM_EP.
+ */
+void XUD_Telemetry(unsigned period_us, unsigned probeBase, unsigned epAddresses[], unsigned epCount);
+#endif
+
+#endif
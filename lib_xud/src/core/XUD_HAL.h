@@ -14,8 +14,6 @@
 
 #if !defined(__XS2A__)
 #include <xs1.h>
-// TODO should be properly in HAL
-unsigned XtlSelFromMhz(unsigned m);
 #else
 #include "XUD_USBTile_Support.h"
 #include "xs1_to_glx.h"
@@ -81,8 +79,30 @@ void XUD_HAL_Mode_DataTransfer();
  **/
 void XUD_HAL_SetDeviceAddress(unsigned char address);
 
+#if !defined(__XS2A__)
+/**
+ * \brief   HAL function to set the USB device address once the next Endpoint 0 IN packet
+ *          (the SET_ADDRESS status stage) is ACKed by the host. The address is applied by XUD.
+ * \param   address        The new address
+ * \return  void
+ **/
+void XUD_HAL_SetDeviceAddressOnAck(unsigned char address);
+#endif
+
+/**
+ * \brief   Power the PHY and release it from reset. The USB clock starts some time later
+ **/
+void XUD_HAL_EnablePhy();
+
+/**
+ * \brief   Divide the tile clock, used to save power whilst suspended
+ * \param   divider        Tile clock divider (2 to 256), 1 restores the undivided tile clock
+ **/
+void XUD_HAL_SetTileClockDivider(unsigned divider);
+
 /**
- * \brief   Enable USB funtionality in the device
+ * \brief   Enable USB funtionality in the device. The PHY must already have been enabled with
+ *          XUD_HAL_EnablePhy()
  **/
 void XUD_HAL_EnableUsb(unsigned pwrConfig);
 
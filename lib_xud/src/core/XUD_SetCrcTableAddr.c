@@ -11,23 +11,58 @@ extern unsigned char crc5Table[2048];
 /* Global table used to store valid CRCs for current address, all other address is this table are invalidated */
 extern unsigned char crc5Table_Addr[2048];
 
-/** XUD_SetCrcTableAddress
- * @brief      Copies CRCs from original valid table to the table we use.  Invalidates entries
- *             which correspnds to the wrong address
- * @param      addr  new device address
- * @return     void
- */
-void XUD_SetCrcTableAddr(unsigned addr)
+/* Table in use by the IO loop */
+unsigned char *g_xudCrcTable = crc5Table_Addr;
+
+static void XUD_FillCrcTable(unsigned char table[], unsigned addr)
 {
     unsigned index;
 
     /* Set whole table to invalid CRC */
-    memset(crc5Table_Addr, 0xff, 2048);
+    memset(table, 0xff, 2048);
 
     /* Copy over relevant entries */
     for(unsigned ep = 0; ep <= 0xF; ep++)
     {
         index = addr + (ep << 7);
-        crc5Table_Addr[index] = crc5Table[index];
+        table[index] = crc5Table[index];
     }
 }
+
+#if !defined(__XS2A__)
+/* Second table, prepared for a new address whilst the IO loop uses the other */
+static unsigned char crc5Table_AddrPending[2048];
+
+/* Table the IO loop switches to once the next EP 0 IN packet is ACKed, 0 if none */
+unsigned char *g_xudPendingCrcTable = 0;
+#endif
+
+/** XUD_SetCrcTableAddress
+ * @brief      Copies CRCs from original valid table to the table we use.  Invalidates entries
+ *             which correspnds to the wrong address
+ * @param      addr  new device address
+ * @return     void
+ */
+void XUD_SetCrcTableAddr(unsigned addr)
+{
+#if !defined(__XS2A__)
+    g_xudPendingCrcTable = 0;
+#endif
+    XUD_FillCrcTable(g_xudCrcTable, addr);
+}
+
+#if !defined(__XS2A__)
+/** XUD_SetCrcTableAddrPending
+ * @brief      Prepares a table for a new address in the table not in use. The IO loop switches to it
+ *             when the next EP 0 IN packet (the SET_ADDRESS status stage) is ACKed
+ * @param      addr  new device address
+ * @return     void
+ */
+void XUD_SetCrcTableAddrPending(unsigned addr)
+{
+    unsigned char *table = (g_xudCrcTable == crc5Table_Addr) ? crc5Table_AddrPending : crc5Table_Addr;
+
+    XUD_FillCrcTable(table, addr);
+    g_xudPendingCrcTable = table;
+}
+#endif
@@ -25,9 +25,21 @@
 #endif
 #define SUSPEND_T_WTWRSTHS_ticks    (SUSPEND_T_WTWRSTHS_us * PLATFORM_REFERENCE_MHZ)
 
+#ifndef SUSPEND_T_RESET_us
+#if (XUD_FAST_RESUME)
+#define SUSPEND_T_RESET_us          (100)     // Reset from suspend: chirp may start 2.5us - 3ms after SE0, allow for PHY clock restart
+#else
+#define SUSPEND_T_RESET_us          (2500)    // 2.5ms
+#endif
+#endif
+#define SUSPEND_T_RESET_ticks       (SUSPEND_T_RESET_us * PLATFORM_REFERENCE_MHZ)
+
 #define OUT_TIMEOUT_us              (500)     // How long we wait for data after OUT token
 #define OUT_TIMEOUT_ticks           (OUT_TIMEOUT_us * PLATFORM_REFERENCE_MHZ)
 #define TX_HANDSHAKE_TIMEOUT_us     (5)      // How long we wait for handshake after sending tx data
 #define TX_HANDSHAKE_TIMEOUT_ticks  (TX_HANDSHAKE_TIMEOUT_us * PLATFORM_REFERENCE_MHZ)
+#define SETUP_TAKEN_us              (20)     // Max time from XUD taking a SETUP ready to informing the client (FS SETUP token + data)
+#define SETUP_TAKEN_ticks           (SETUP_TAKEN_us * PLATFORM_REFERENCE_MHZ)
+#define SETUP_MARK_ticks            (10)     // Max time from XUD taking a SETUP ready to marking the SETUP in flight (a few IO loop instructions)
 
 #endif
@@ -0,0 +1,32 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+/** @file      XUD_BootProfile.c
+  * @brief     XUD start up and resume profiles. See XUD_GetBootProfile() and XUD_GetResumeProfile()
+  *            in xud.h for documentation.
+  **/
+
+#include "xud.h"
+
+#if (XUD_PROFILE)
+
+/* Written by XUD, see XUD_Main.xc */
+extern unsigned g_xudBootProfile[XUD_BOOT_STAGE_COUNT];
+extern unsigned g_xudResumeProfile[XUD_RESUME_STAGE_COUNT];
+
+void XUD_GetBootProfile(unsigned times[XUD_BOOT_STAGE_COUNT])
+{
+    for(int i = 0; i < XUD_BOOT_STAGE_COUNT; i++)
+    {
+        times[i] = ((volatile unsigned *) g_xudBootProfile)[i];
+    }
+}
+
+void XUD_GetResumeProfile(unsigned times[XUD_RESUME_STAGE_COUNT])
+{
+    for(int i = 0; i < XUD_RESUME_STAGE_COUNT; i++)
+    {
+        times[i] = ((volatile unsigned *) g_xudResumeProfile)[i];
+    }
+}
+
+#endif
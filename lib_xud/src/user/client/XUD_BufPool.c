@@ -0,0 +1,155 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+/** @file      XUD_BufPool.c
+  * @brief     Reference counted packet buffer pool. See xud_bufpool.h for documentation.
+  **/
+
+#include <xs1.h>
+#include "xud_bufpool.h"
+
+#if (XUD_BUFPOOL_COUNT)
+
+#if (XUD_BUFPOOL_COUNT > 32)
+#error XUD_BUFPOOL_COUNT must be 32 or less
+#endif
+
+#if (XUD_BUFPOOL_SIZE & 3)
+#error XUD_BUFPOOL_SIZE must be a multiple of 4
+#endif
+
+static unsigned g_bufPool[XUD_BUFPOOL_COUNT][XUD_BUFPOOL_SIZE/4];
+static unsigned g_bufPoolRefCount[XUD_BUFPOOL_COUNT];
+static unsigned g_bufPoolLength[XUD_BUFPOOL_COUNT];
+static unsigned g_bufPoolFree;          /* Bit n set: buffer n free */
+static unsigned g_bufPoolLock;          /* Hardware lock guarding free mask and reference counts */
+
+static inline void XUD_BufPool_Lock()
+{
+    unsigned tmp;
+    asm volatile("in %0, res[%1]" : "=r"(tmp) : "r"(g_bufPoolLock) : "memory");
+}
+
+static inline void XUD_BufPool_Unlock()
+{
+    asm volatile("out res[%0], %0" : : "r"(g_bufPoolLock) : "memory");
+}
+
+XUD_Result_t XUD_BufPool_Init(void)
+{
+    asm volatile("getr %0, %1" : "=r"(g_bufPoolLock) : "n"(XS1_RES_TYPE_LOCK));
+
+    /* No hardware lock free on this tile */
+    if(!g_bufPoolLock)
+        return XUD_RES_ERR;
+
+    for(int i = 0; i < XUD_BUFPOOL_COUNT; i++)
+    {
+        g_bufPoolRefCount[i] = 0;
+        g_bufPoolLength[i] = 0;
+    }
+
+    g_bufPoolFree = (unsigned)((1ULL << XUD_BUFPOOL_COUNT) - 1);
+
+    return XUD_RES_OKAY;
+}
+
+XUD_BufHandle_t XUD_BufPool_Alloc(void)
+{
+    XUD_BufHandle_t h = XUD_BUF_HANDLE_NONE;
+
+    XUD_BufPool_Lock();
+
+    if(g_bufPoolFree)
+    {
+        unsigned i = 31 - __builtin_clz(g_bufPoolFree);
+        g_bufPoolFree &= ~(1u << i);
+        g_bufPoolRefCount[i] = 1;
+        g_bufPoolLength[i] = 0;
+        h = i + 1;
+    }
+
+    XUD_BufPool_Unlock();
+
+    return h;
+}
+
+void XUD_BufPool_Retain(XUD_BufHandle_t h)
+{
+    if(h == XUD_BUF_HANDLE_NONE)
+        return;
+
+    XUD_BufPool_Lock();
+    g_bufPoolRefCount[h - 1]++;
+    XUD_BufPool_Unlock();
+}
+
+XUD_Result_t XUD_BufPool_Release(XUD_BufHandle_t h)
+{
+    XUD_Result_t result = XUD_RES_OKAY;
+
+    if(h == XUD_BUF_HANDLE_NONE)
+        return XUD_RES_OKAY;
+
+    XUD_BufPool_Lock();
+    if(g_bufPoolRefCount[h - 1] == 0)
+    {
+        /* Already free, e.g. released twice. Leave the pool untouched */
+        result = XUD_RES_ERR;
+    }
+    else if(--g_bufPoolRefCount[h - 1] == 0)
+    {
+        g_bufPoolFree |= (1u << (h - 1));
+    }
+    XUD_BufPool_Unlock();
+
+    return result;
+}
+
+unsigned XUD_BufPool_Addr(XUD_BufHandle_t h)
+{
+    return (unsigned) &g_bufPool[h - 1][0];
+}
+
+unsigned XUD_BufPool_GetLength(XUD_BufHandle_t h)
+{
+    return g_bufPoolLength[h - 1];
+}
+
+void XUD_BufPool_SetLength(XUD_BufHandle_t h, unsigned length)
+{
+    g_bufPoolLength[h - 1] = length;
+}
+
+XUD_Result_t XUD_SetReady_OutBuf(XUD_ep ep, XUD_BufHandle_t h)
+{
+    if(h == XUD_BUF_HANDLE_NONE)
+        return XUD_RES_ERR;
+
+    return XUD_SetReady_OutPtr(ep, XUD_BufPool_Addr(h));
+}
+
+XUD_Result_t XUD_SetReady_InBuf(XUD_ep ep, XUD_BufHandle_t h)
+{
+    if(h == XUD_BUF_HANDLE_NONE)
+        return XUD_RES_ERR;
+
+    return XUD_SetReady_InPtr(ep, XUD_BufPool_Addr(h), g_bufPoolLength[h - 1]);
+}
+
+XUD_Result_t XUD_GetBufferHandle(XUD_ep ep, XUD_BufHandle_t h)
+{
+    if(h == XUD_BUF_HANDLE_NONE)
+        return XUD_RES_ERR;
+
+    return XUD_GetBuffer(ep, (unsigned char *) XUD_BufPool_Addr(h), &g_bufPoolLength[h - 1]);
+}
+
+XUD_Result_t XUD_SetBufferHandle(XUD_ep ep, XUD_BufHandle_t h)
+{
+    if(h == XUD_BUF_HANDLE_NONE)
+        return XUD_RES_ERR;
+
+    return XUD_SetBuffer(ep, (unsigned char *) XUD_BufPool_Addr(h), g_bufPoolLength[h - 1]);
+}
+
+#endif
@@ -0,0 +1,100 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+/** @file      XUD_ControlStream.c
+  * @brief     Streaming control transfer data stages. See xud.h for documentation.
+  **/
+
+#include "xud.h"
+
+/* Largest EP0 packet (USB 2.0 9.6.1) plus CRC, word aligned */
+#define XUD_STREAM_BUFFER_WORDS ((64 / 4) + 1)
+
+static inline unsigned min(unsigned x, unsigned y)
+{
+    return x < y ? x : y;
+}
+
+XUD_Result_t XUD_DoGetRequestStream(XUD_ep ep_out, XUD_ep ep_in, unsigned length, unsigned requested,
+    XUD_ControlProducer_t producer, void *user)
+{
+    unsigned buffer[XUD_STREAM_BUFFER_WORDS];
+    unsigned sendLength = min(length, requested);
+    unsigned offset = 0;
+    unsigned rxlength;
+    unsigned epMax = XUD_GetEp0MaxPacketSize();
+    XUD_Result_t result;
+
+    while(1)
+    {
+        unsigned chunk = min(sendLength - offset, epMax);
+
+        if(chunk)
+        {
+            unsigned produced = producer(user, offset, (unsigned char *) buffer, chunk);
+
+            /* Producer wrote past the packet */
+            if(produced > chunk)
+            {
+                return XUD_RES_ERR;
+            }
+
+            chunk = produced;
+        }
+
+        if((result = XUD_SetBuffer(ep_in, (unsigned char *) buffer, chunk)) != XUD_RES_OKAY)
+        {
+            return result;
+        }
+
+        offset += chunk;
+
+        /* A short packet (including a 0 length packet) ends the data stage, as does sending the
+         * requested length exactly. USB 2.0 8.5.3.2: Otherwise a full packet must be followed by another */
+        if((chunk < epMax) || (offset == requested))
+        {
+            break;
+        }
+    }
+
+    /* Status stage - this should return -1 for reset or 0 for 0 length status stage packet */
+    return XUD_GetBuffer(ep_out, (unsigned char *) buffer, &rxlength);
+}
+
+XUD_Result_t XUD_DoSetRequestStream(XUD_ep ep_out, XUD_ep ep_in, unsigned length,
+    XUD_ControlConsumer_t consumer, void *user)
+{
+    unsigned buffer[XUD_STREAM_BUFFER_WORDS];
+    unsigned offset = 0;
+    unsigned rxlength;
+    unsigned epMax = XUD_GetEp0MaxPacketSize();
+    XUD_Result_t result;
+
+    while(offset < length)
+    {
+        if((result = XUD_GetBuffer(ep_out, (unsigned char *) buffer, &rxlength)) != XUD_RES_OKAY)
+        {
+            return result;
+        }
+
+        if((rxlength > epMax) || ((offset + rxlength) > length))
+        {
+            return XUD_RES_ERR;
+        }
+
+        if(consumer(user, offset, (unsigned char *) buffer, rxlength))
+        {
+            return XUD_RES_ERR;
+        }
+
+        offset += rxlength;
+
+        /* Short packet ends the data stage */
+        if(rxlength < epMax)
+        {
+            break;
+        }
+    }
+
+    /* Status stage */
+    return XUD_DoSetRequestStatus(ep_in);
+}
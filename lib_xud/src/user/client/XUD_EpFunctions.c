@@ -6,6 +6,10 @@
 
 extern XUD_ep_info ep_info[USB_MAX_NUM_EP];
 
+#if (XUD_SOF_ARM_EP_COUNT)
+extern unsigned epAddr_SofArm[XUD_SOF_ARM_EP_COUNT];
+#endif
+
 void XUD_ResetEpStateByAddr(unsigned epAddr)
 {
     unsigned pid = USB_PIDn_DATA0;
@@ -40,6 +44,17 @@ void XUD_SetStallByAddr(int epNum)
 
     unsigned *epReadyEntry = (unsigned *)ep->array_ptr;
 
+#if (XUD_SOF_ARM_EP_COUNT)
+    /* Disarm a SOF-armed EP so it is not marked ready whilst halted. Treated as ready at halting
+     * so the data is sent once the stall is cleared */
+    unsigned sofArmIdx = epNum - USB_MAX_NUM_EP_OUT;
+    if((epNum >= USB_MAX_NUM_EP_OUT) && (sofArmIdx < XUD_SOF_ARM_EP_COUNT) && epAddr_SofArm[sofArmIdx])
+    {
+        epAddr_SofArm[sofArmIdx] = 0;
+        ep->saved_array_ptr = (unsigned) ep;
+    }
+#endif
+
     if(*epReadyEntry != 0)
     {
         /* Mark EP as not ready (and save that it was ready at Halting */
@@ -169,6 +184,25 @@ XUD_Result_t XUD_GetBuffer_Finish(chanend c, XUD_ep e, unsigned *datalength)
     return XUD_RES_OKAY;
 }  // NOCOVER
 
+static unsigned g_ep0MaxPacketSize = EP0_MAX_PACKET_SIZE;
+
+XUD_Result_t XUD_SetEp0MaxPacketSize(unsigned size)
+{
+    /* USB 2.0 9.6.1: bMaxPacketSize0 is 8, 16, 32 or 64 */
+    if((size != 8) && (size != 16) && (size != 32) && (size != 64))
+    {
+        return XUD_RES_ERR;
+    }
+
+    g_ep0MaxPacketSize = size;
+    return XUD_RES_OKAY;
+}
+
+unsigned XUD_GetEp0MaxPacketSize(void)
+{
+    return g_ep0MaxPacketSize;
+}
+
 XUD_Result_t XUD_DoSetRequestStatus(XUD_ep ep_in)
 {
     unsigned char tmp[8];
@@ -214,25 +248,63 @@ void XUD_GetData_Select(chanend c, XUD_ep e, unsigned *datalength, XUD_Result_t
     *result = XUD_GetBuffer_Finish(ep->client_chanend, e, datalength);
 }
 
-XUD_Result_t XUD_GetSetupBuffer(XUD_ep e, unsigned char buffer[], unsigned *datalength)
+#if (XUD_EP_TIMESTAMPS)
+unsigned XUD_GetTimestamp(XUD_ep e)
 {
-    volatile XUD_ep_info *ep = (XUD_ep_info*) e;
-    unsigned isReset;
-    unsigned length;
-    unsigned lengthTail;
+    volatile XUD_ep_info * ep = (XUD_ep_info*) e;
 
-    /* Check if we missed a reset */
-    if(ep->resetting)
+    return ep->timestamp;
+}
+#endif
+
+#if (XUD_SETUP_BUFFER)
+/* Takes a SETUP held in the XUD owned buffer, if any. XUD lands SETUPs in alternating buffers so the one
+ * being copied is only overwritten if two more arrive during the copy, in which case copy again */
+static int XUD_TakeHeldSetup(volatile XUD_ep_info *ep, unsigned char buffer[])
+{
+    unsigned seq;
+
+    if(ep->setupSeq == ep->setupSeqRead)
     {
-        return XUD_RES_RST;
+        return 0;
     }
 
-    /* Store buffer address in EP structure */
-    ep->buffer = (unsigned) &buffer[0];
+    do
+    {
+        seq = ep->setupSeq;
+        volatile unsigned *held = (unsigned *)(ep->setupBuffer + ((seq & 1) << XUD_SETUP_BUFFER_SHIFT));
+        for(int i = 0; i < 8; i++)
+        {
+            buffer[i] = ((volatile unsigned char *)held)[i];
+        }
+    }
+    while(ep->setupSeq != seq);
 
-    /* Mark EP as ready for SETUP data */
-    unsigned * array_ptr_setup = (unsigned *)ep->array_ptr_setup;
-    *array_ptr_setup = (unsigned) ep;
+    ep->setupSeqRead = seq;
+    return 1;
+}
+#endif
+
+/* Reset PID toggling on receipt of SETUP (both IN and OUT) */
+static inline void XUD_SetupReceived(volatile XUD_ep_info *ep)
+{
+#ifdef __XS2A__
+    ep->pid = USB_PID_DATA1;
+#else
+    ep->pid = USB_PIDn_DATA1;
+#endif
+
+    /* Reset IN EP PID */
+    XUD_ep_info *ep_in = (XUD_ep_info*) ((unsigned)ep + (USB_MAX_NUM_EP_OUT * sizeof(XUD_ep_info)));
+    ep_in->pid = USB_PIDn_DATA1;
+}
+
+/* Input the XUD response to a SETUP ready */
+static inline XUD_Result_t XUD_GetSetupBuffer_Finish(volatile XUD_ep_info *ep, unsigned *datalength)
+{
+    unsigned isReset;
+    unsigned length;
+    unsigned lengthTail;
 
     /* Wait for XUD response */
     asm volatile("testct %0, res[%1]" : "=r"(isReset) : "r"(ep->client_chanend));
@@ -249,16 +321,7 @@ XUD_Result_t XUD_GetSetupBuffer(XUD_ep e, unsigned char buffer[], unsigned *data
     /* TODO Check CT vs T */
     asm volatile("inct %0, res[%1]" : "=r"(lengthTail) : "r"(ep->client_chanend));
 
-    /* Reset PID toggling on receipt of SETUP (both IN and OUT) */
-#ifdef __XS2A__
-    ep->pid = USB_PID_DATA1;
-#else
-    ep->pid = USB_PIDn_DATA1;
-#endif
-
-    /* Reset IN EP PID */
-    XUD_ep_info *ep_in = (XUD_ep_info*) ((unsigned)ep + (USB_MAX_NUM_EP_OUT * sizeof(XUD_ep_info)));
-    ep_in->pid = USB_PIDn_DATA1;
+    XUD_SetupReceived(ep);
 
     /* TODO check that this is the case */
     *datalength = 8;
@@ -266,6 +329,86 @@ XUD_Result_t XUD_GetSetupBuffer(XUD_ep e, unsigned char buffer[], unsigned *data
     return XUD_RES_OKAY;
 }
 
+int XUD_SetReady_Setup(XUD_ep e, unsigned char buffer[])
+{
+    volatile XUD_ep_info *ep = (XUD_ep_info*) e;
+
+    /* Check if we missed a reset */
+    if(ep->resetting)
+    {
+        return XUD_RES_RST;
+    }
+
+#if (XUD_SETUP_BUFFER)
+    /* SETUP received whilst we were busy */
+    if(XUD_TakeHeldSetup(ep, buffer))
+    {
+        XUD_SetupReceived(ep);
+        return XUD_SETUP_HELD;
+    }
+#endif
+
+    /* Store buffer address in EP structure */
+    ep->buffer = (unsigned) &buffer[0];
+
+    /* Mark EP as ready for SETUP data */
+    volatile unsigned * array_ptr_setup = (unsigned *)ep->array_ptr_setup;
+    *array_ptr_setup = (unsigned) ep;
+
+#if (XUD_SETUP_BUFFER)
+    /* A SETUP may have been held just before we marked ready. Withdraw the ready, XUD may take it at any
+     * point so this waits on the in flight mark as XUD_ClearReady_Setup() does. If XUD took it the SETUP
+     * it received is newer and replaces the held one */
+    if(ep->setupSeq != ep->setupSeqRead)
+    {
+        unsigned seq = ep->setupSeq;
+        unsigned length;
+        XUD_Result_t result;
+
+        if(XUD_ClearReady_Setup(ep->client_chanend, e, &length, &result))
+        {
+            ep->setupSeqRead = seq;
+            return (result == XUD_RES_RST) ? XUD_RES_RST : XUD_SETUP_HELD;
+        }
+
+        XUD_TakeHeldSetup(ep, buffer);
+        XUD_SetupReceived(ep);
+        return XUD_SETUP_HELD;
+    }
+#endif
+
+    return XUD_RES_OKAY;
+}
+
+void XUD_GetSetup_Select(chanend c, XUD_ep e, unsigned *datalength, XUD_Result_t *result)
+{
+    volatile XUD_ep_info *ep = (XUD_ep_info*) e;
+
+    *result = XUD_GetSetupBuffer_Finish(ep, datalength);
+}
+
+XUD_Result_t XUD_GetSetupBuffer(XUD_ep e, unsigned char buffer[], unsigned *datalength)
+{
+    volatile XUD_ep_info *ep = (XUD_ep_info*) e;
+
+    int ready = XUD_SetReady_Setup(e, buffer);
+
+    if(ready == XUD_RES_RST)
+    {
+        return XUD_RES_RST;
+    }
+
+#if (XUD_SETUP_BUFFER)
+    if(ready == XUD_SETUP_HELD)
+    {
+        *datalength = 8;
+        return XUD_RES_OKAY;
+    }
+#endif
+
+    return XUD_GetSetupBuffer_Finish(ep, datalength);
+}
+
 XUD_Result_t XUD_SetBuffer_Start(XUD_ep e, unsigned char buffer[], unsigned datalength)
 {   // NOCOVER
     volatile XUD_ep_info * ep = (XUD_ep_info*) e;
@@ -308,6 +451,61 @@ XUD_Result_t XUD_SetBuffer_Start(XUD_ep e, unsigned char buffer[], unsigned data
     return XUD_RES_OKAY;
 }
 
+#if (XUD_SOF_ARM_EP_COUNT)
+XUD_Result_t XUD_SetReady_InSof(XUD_ep e, unsigned char buffer[], int len, unsigned sofCount)
+{
+    volatile XUD_ep_info * ep = (XUD_ep_info*) e;
+    unsigned epNum = ep->epAddress & 0x7F;
+
+    if(((ep->epAddress & 0x80) == 0) || (epNum >= XUD_SOF_ARM_EP_COUNT))
+    {
+        return XUD_RES_ERR;
+    }
+
+    /* Arming a halted EP would have it sent on SOF rather than stalled */
+    if(ep->halted == USB_PIDn_STALL)
+    {
+        return XUD_RES_ERR;
+    }
+
+    if(sofCount == 0)
+    {
+        return XUD_SetReady_In(e, buffer, len);
+    }
+
+    /* Check if we missed a reset */
+    if(ep->resetting)
+    {
+        return XUD_RES_RST;
+    }
+
+    int lengthWords = len >> 2;
+    unsigned lengthTail = (len << 3) & 0x1f;
+
+    if((lengthTail == 0) && (lengthWords != 0))
+    {
+        lengthWords -= 1;
+        lengthTail = 32;
+    }
+
+    /* Store end of buffer address in EP structure */
+    ep->buffer = (unsigned) &buffer[0] + (lengthWords * 4);
+
+    /* Store neg index */
+    ep->actualPid = -lengthWords;
+
+    /* Store tail len */
+    ep->tailLength = lengthTail;
+
+    /* Arm EP, XUD marks it ready when the count reaches 0 */
+    ep->sofCount = sofCount;
+    volatile unsigned * sofArm = &epAddr_SofArm[epNum];
+    *sofArm = (unsigned) ep;
+
+    return XUD_RES_OKAY;
+}
+#endif
+
 XUD_Result_t XUD_SetBuffer_Finish(chanend c, XUD_ep e)
 {   // NOCOVER
     volatile XUD_ep_info * ep = (XUD_ep_info*) e;
@@ -404,3 +602,183 @@ XUD_Result_t XUD_SetBuffer_EpMax(XUD_ep ep_in, unsigned char buffer[], unsigned
 
     return XUD_RES_OKAY;
 }
+
+#if (XUD_ISO_BATCH)
+static void XUD_IsoBatch_Start(volatile XUD_ep_info *ep, volatile XUD_IsoBatch_t *batch)
+{
+    volatile XUD_IsoBatchPacket_t *packet = (XUD_IsoBatchPacket_t *) batch->cursor;
+
+    ep->batch = (unsigned) batch;
+    ep->buffer = packet->buffer;
+
+    if(ep->epAddress & 0x80)
+    {
+        ep->actualPid = packet->length;
+        ep->tailLength = packet->tail;
+    }
+
+    /* Mark EP as ready */
+    unsigned * array_ptr = (unsigned *)ep->array_ptr;
+    *array_ptr = (unsigned) ep;
+}
+
+static XUD_Result_t XUD_IsoBatch_Arm(volatile XUD_ep_info *ep, volatile XUD_IsoBatch_t *batch, unsigned count)
+{
+    unsigned * array_ptr = (unsigned *)ep->array_ptr;
+    volatile XUD_IsoBatch_t *active = (XUD_IsoBatch_t *) ep->batch;
+
+    /* Check if we missed a reset */
+    if(ep->resetting)
+    {
+        return XUD_RES_RST;
+    }
+
+    batch->next = 0;
+    batch->count = count;
+    batch->cursor = (unsigned) &batch->packets[0];
+    batch->end = (unsigned) &batch->packets[count];
+
+    if(*array_ptr && active)
+    {
+        /* Batch in progress - queue behind it. If XUD completes the active batch before seeing
+         * the link the batch is started from XUD_IsoBatch_Finish() */
+        active->next = (unsigned) batch;
+    }
+    else
+    {
+        XUD_IsoBatch_Start(ep, batch);
+    }
+
+    return XUD_RES_OKAY;
+}
+
+static XUD_Result_t XUD_IsoBatch_Finish(volatile XUD_ep_info *ep, unsigned lengths[])
+{
+    unsigned isReset;
+    volatile XUD_IsoBatch_t *batch;
+
+    /* Wait for XUD response */
+    asm volatile("testct %0, res[%1]" : "=r"(isReset) : "r"(ep->client_chanend));
+
+    if(isReset)
+    {
+        return XUD_RES_RST;
+    }
+
+    /* Input completed batch */
+    asm volatile("in %0, res[%1]" : "=r"(batch) : "r"(ep->client_chanend));
+
+    /* XUD stopped rather than continuing with a next batch, but one was queued after it checked.
+     * XUD clears the link of a batch it continues from, so a queued batch that XUD has already
+     * run (and maybe completed) is never restarted here */
+    if((ep->batch == 0) && batch->next)
+    {
+        XUD_IsoBatch_Start(ep, (XUD_IsoBatch_t *) batch->next);
+    }
+
+    if(lengths)
+    {
+        for(int i = 0; i < batch->count; i++)
+        {
+            /* Words and tail bits to bytes, -2 length correction for CRC */
+            lengths[i] = (batch->packets[i].length << 2) + (batch->packets[i].tail >> 3) - 2;
+        }
+    }
+
+    return XUD_RES_OKAY;
+}
+
+XUD_Result_t XUD_SetReady_InBatch(XUD_ep e, XUD_IsoBatch_t *batch, unsigned char buffer[],
+    unsigned stride, unsigned lengths[], unsigned count)
+{
+    volatile XUD_ep_info * ep = (XUD_ep_info*) e;
+    volatile XUD_IsoBatch_t * b = batch;
+
+    if((count == 0) || (count > XUD_ISO_BATCH_MAX))
+    {
+        return XUD_RES_ERR;
+    }
+
+    for(int i = 0; i < count; i++)
+    {
+        int lengthWords = lengths[i] >> 2;
+        unsigned lengthTail = (lengths[i] << 3) & 0x1f;
+
+        if((lengthTail == 0) && (lengthWords != 0))
+        {
+            lengthWords -= 1;
+            lengthTail = 32;
+        }
+
+        /* End of buffer address, negative word index from end */
+        b->packets[i].buffer = (unsigned) &buffer[i * stride] + (lengthWords * 4);
+        b->packets[i].length = -lengthWords;
+        b->packets[i].tail = lengthTail;
+    }
+
+    return XUD_IsoBatch_Arm(ep, b, count);
+}
+
+XUD_Result_t XUD_SetReady_OutBatch(XUD_ep e, XUD_IsoBatch_t *batch, unsigned char buffer[],
+    unsigned stride, unsigned count)
+{
+    volatile XUD_ep_info * ep = (XUD_ep_info*) e;
+    volatile XUD_IsoBatch_t * b = batch;
+
+    if((count == 0) || (count > XUD_ISO_BATCH_MAX))
+    {
+        return XUD_RES_ERR;
+    }
+
+    for(int i = 0; i < count; i++)
+    {
+        b->packets[i].buffer = (unsigned) &buffer[i * stride];
+    }
+
+    return XUD_IsoBatch_Arm(ep, b, count);
+}
+
+XUD_Result_t XUD_SetBufferBatch(XUD_ep e, XUD_IsoBatch_t *batch, unsigned char buffer[],
+    unsigned stride, unsigned lengths[], unsigned count)
+{
+    volatile XUD_ep_info * ep = (XUD_ep_info*) e;
+
+    XUD_Result_t result = XUD_SetReady_InBatch(e, batch, buffer, stride, lengths, count);
+
+    if(result != XUD_RES_OKAY)
+    {
+        return result;
+    }
+
+    return XUD_IsoBatch_Finish(ep, 0);
+}
+
+XUD_Result_t XUD_GetBufferBatch(XUD_ep e, XUD_IsoBatch_t *batch, unsigned char buffer[],
+    unsigned stride, unsigned lengths[], unsigned count)
+{
+    volatile XUD_ep_info * ep = (XUD_ep_info*) e;
+
+    XUD_Result_t result = XUD_SetReady_OutBatch(e, batch, buffer, stride, count);
+
+    if(result != XUD_RES_OKAY)
+    {
+        return result;
+    }
+
+    return XUD_IsoBatch_Finish(ep, lengths);
+}
+
+void XUD_GetBatch_Select(chanend c, XUD_ep e, unsigned lengths[], XUD_Result_t *result)
+{
+    volatile XUD_ep_info * ep = (XUD_ep_info*) e;
+
+    *result = XUD_IsoBatch_Finish(ep, lengths);
+}
+
+void XUD_SetBatch_Select(chanend c, XUD_ep e, XUD_Result_t *result)
+{
+    volatile XUD_ep_info * ep = (XUD_ep_info*) e;
+
+    *result = XUD_IsoBatch_Finish(ep, 0);
+}
+#endif
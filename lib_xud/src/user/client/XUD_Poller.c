@@ -0,0 +1,167 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+/** @file      XUD_Poller.c
+  * @brief     Single-thread multi-endpoint event poller. See xud_poller.h for documentation.
+  **/
+
+#include <stddef.h>
+#include "xud_poller.h"
+#include "XUD_USB_Defines.h"
+
+XUD_Result_t XUD_GetBuffer_Finish(chanend c, XUD_ep e, unsigned *datalength);
+XUD_Result_t XUD_SetBuffer_Start(XUD_ep e, unsigned char buffer[], unsigned datalength);
+XUD_Result_t XUD_SetBuffer_Finish(chanend c, XUD_ep e);
+
+/* Waits for an event on any of the chanends, returns the index of the chanend that fired */
+unsigned XUD_Poller_WaitEvent(unsigned chanends[], unsigned count);
+
+void XUD_Poller_Init(XUD_Poller_t *poller)
+{
+    poller->count = 0;
+}
+
+static XUD_Result_t XUD_Poller_ArmEp(XUD_PollerEp_t *pep)
+{
+    XUD_Result_t result;
+
+    if(pep->isIn)
+    {
+        result = XUD_SetBuffer_Start(pep->ep, pep->buffer, pep->length);
+    }
+    else
+    {
+        result = XUD_SetReady_Out(pep->ep, pep->buffer);
+    }
+
+    pep->armed = (result == XUD_RES_OKAY);
+
+    return result;
+}
+
+int XUD_Poller_Add(XUD_Poller_t *poller, XUD_ep ep, unsigned priority, unsigned char *buffer, unsigned length,
+    XUD_PollerCallback_t callback, void *user)
+{
+    volatile XUD_ep_info *epInfo = (XUD_ep_info *) ep;
+    unsigned i;
+
+    /* Control endpoint 0 needs the SETUP/data/status sequencing of USB_StandardRequests() */
+    if((poller->count >= XUD_POLLER_MAX_EP) || ((epInfo->epAddress & 0x7F) == 0))
+    {
+        return -1;
+    }
+
+    /* Keep endpoints sorted by priority, stable for equal priorities */
+    for(i = poller->count; (i > 0) && (poller->eps[i - 1].priority > priority); i--)
+    {
+        poller->eps[i] = poller->eps[i - 1];
+        poller->chanends[i] = poller->chanends[i - 1];
+    }
+
+    XUD_PollerEp_t *pep = &poller->eps[i];
+
+    pep->ep = ep;
+    pep->isIn = (epInfo->epAddress & 0x80) != 0;
+    pep->armed = 0;
+    pep->priority = priority;
+    pep->buffer = buffer;
+    pep->length = length;
+    pep->callback = callback;
+    pep->user = user;
+    poller->chanends[i] = epInfo->client_chanend;
+    poller->count++;
+
+    if(buffer != NULL)
+    {
+        /* A failure here is a pending reset, this is picked up by XUD_Poller_Poll() */
+        XUD_Poller_ArmEp(pep);
+    }
+
+    return i;
+}
+
+XUD_Result_t XUD_Poller_Arm(XUD_Poller_t *poller, XUD_ep ep, unsigned char *buffer, unsigned length)
+{
+    for(unsigned i = 0; i < poller->count; i++)
+    {
+        XUD_PollerEp_t *pep = &poller->eps[i];
+
+        if(pep->ep == ep)
+        {
+            pep->buffer = buffer;
+            pep->length = length;
+            return XUD_Poller_ArmEp(pep);
+        }
+    }
+
+    return XUD_RES_ERR;
+}
+
+static void XUD_Poller_Dispatch(XUD_PollerEp_t *pep, XUD_Result_t result)
+{
+    if(pep->callback(pep->user, result, &pep->buffer, &pep->length))
+    {
+        XUD_Poller_ArmEp(pep);
+    }
+}
+
+void XUD_Poller_Poll(XUD_Poller_t *poller)
+{
+    XUD_Poller_WaitEvent(poller->chanends, poller->count);
+
+    /* Service every endpoint with a pending completion in priority order, not just the one that woke us */
+    for(unsigned i = 0; i < poller->count; i++)
+    {
+        XUD_PollerEp_t *pep = &poller->eps[i];
+        volatile XUD_ep_info *ep = (XUD_ep_info *) pep->ep;
+        XUD_Result_t result;
+
+        if(ep->resetting && !pep->armed)
+        {
+            XUD_ResetEndpoint(pep->ep, NULL);
+            XUD_Poller_Dispatch(pep, XUD_RES_RST);
+            continue;
+        }
+
+        /* XUD clears the ready entry before notifying. A halted EP has its ready entry saved,
+         * so is not considered complete */
+        unsigned complete = pep->armed && (*(unsigned *)ep->array_ptr == 0) && (ep->saved_array_ptr == 0);
+
+        if(!complete && !ep->resetting)
+        {
+            continue;
+        }
+
+        pep->armed = 0;
+
+        if(pep->isIn)
+        {
+            result = XUD_SetBuffer_Finish(ep->client_chanend, pep->ep);
+        }
+        else
+        {
+            result = XUD_GetBuffer_Finish(ep->client_chanend, pep->ep, &pep->length);
+
+            if(result == XUD_RES_ERR)
+            {
+                /* Bad PID sequence - packet dropped, receive again */
+                XUD_Poller_ArmEp(pep);
+                continue;
+            }
+        }
+
+        if(result == XUD_RES_RST)
+        {
+            XUD_ResetEndpoint(pep->ep, NULL);
+        }
+
+        XUD_Poller_Dispatch(pep, result);
+    }
+}
+
+void XUD_Poller_Run(XUD_Poller_t *poller)
+{
+    while(1)
+    {
+        XUD_Poller_Poll(poller);
+    }
+}
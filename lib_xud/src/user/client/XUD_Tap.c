@@ -0,0 +1,71 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+/** @file      XUD_Tap.c
+  * @brief     Endpoint traffic tap observer side. See xud_tap.h for documentation.
+  **/
+
+#include <string.h>
+#include "xud_tap.h"
+#include "XUD_USB_Defines.h"
+
+#if (XUD_TAP)
+
+#if (XUD_TAP_ENTRIES_LOG2 < 1) || (XUD_TAP_ENTRIES_LOG2 > 8)
+#error XUD_TAP_ENTRIES_LOG2 must be between 1 and 8
+#endif
+
+extern XUD_ep_info ep_info[USB_MAX_NUM_EP];
+
+/* Written by XUD (XUD_TapRecord), see XUD_Main.xc */
+extern unsigned g_xudTapRing[1 << XUD_TAP_ENTRIES_LOG2][4];
+extern unsigned g_xudTapWr;
+extern unsigned g_xudTapRd;
+extern unsigned g_xudTapDropped;
+
+void XUD_Tap_Enable(unsigned epAddress, unsigned enable)
+{
+    unsigned i = epAddress & 0x7F;
+
+    if(epAddress & 0x80)
+    {
+        i += USB_MAX_NUM_EP_OUT;
+    }
+
+    ((volatile XUD_ep_info *) ep_info)[i].tap = (enable != 0);
+}
+
+int XUD_Tap_Read(XUD_TapDesc_t *desc, unsigned char payload[], unsigned maxLength)
+{
+    volatile unsigned *wr = &g_xudTapWr;
+    volatile unsigned *rd = &g_xudTapRd;
+    unsigned index = *rd;
+
+    if(index == *wr)
+    {
+        return 0;
+    }
+
+    volatile unsigned *entry = g_xudTapRing[index & ((1 << XUD_TAP_ENTRIES_LOG2) - 1)];
+
+    desc->epAddress = entry[0];
+    desc->length = entry[1];
+    desc->buffer = entry[2];
+    desc->timestamp = entry[3];
+
+    /* Release the descriptor before the (slow) payload copy */
+    *rd = index + 1;
+
+    if(maxLength)
+    {
+        memcpy(payload, (unsigned char *) desc->buffer, desc->length < maxLength ? desc->length : maxLength);
+    }
+
+    return 1;
+}
+
+unsigned XUD_Tap_GetDropped(void)
+{
+    return *(volatile unsigned *) &g_xudTapDropped;
+}
+
+#endif
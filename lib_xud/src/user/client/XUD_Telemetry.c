@@ -0,0 +1,188 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+/** @file      XUD_Telemetry.c
+  * @brief     Live USB telemetry over xSCOPE. See xud_telemetry.h for documentation.
+  **/
+
+#include <platform.h>
+#include <xscope.h>
+#include <xcore/hwtimer.h>
+#include "xud_telemetry.h"
+#include "xud_tap.h"
+#include "XUD_USB_Defines.h"
+
+#if (XUD_TELEMETRY)
+
+#if !(XUD_TAP)
+#error XUD_TELEMETRY requires XUD_TAP
+#endif
+
+extern unsigned g_curSpeed;
+extern unsigned epAddr_Ready[USB_MAX_NUM_EP + USB_MAX_NUM_EP_OUT];
+
+/* Written by XUD, see XUD_Main.xc */
+extern unsigned g_xudNakCount[USB_MAX_NUM_EP];
+extern unsigned g_xudSofIntervalMin;
+extern unsigned g_xudSofIntervalMax;
+
+static unsigned EpIndex(unsigned epAddress)
+{
+    unsigned i = epAddress & 0x7F;
+
+    if(epAddress & 0x80)
+    {
+        i += USB_MAX_NUM_EP_OUT;
+    }
+    return i;
+}
+
+/* Time between checks of the tap whilst waiting for the end of a period. Short enough that the tap
+ * ring cannot fill with back to back maximum size HS packets */
+#ifndef XUD_TELEMETRY_POLL_us
+#define XUD_TELEMETRY_POLL_us (10)
+#endif
+
+XUD_Result_t XUD_Telemetry_Init(XUD_Telemetry_t *telemetry, unsigned period_us, unsigned epAddresses[], unsigned epCount)
+{
+    volatile unsigned *naks = g_xudNakCount;
+
+    if(epCount > USB_MAX_NUM_EP)
+        return XUD_RES_ERR;
+
+    /* Held for the life of the sampler, Sample() runs once per period */
+    telemetry->timer = hwtimer_alloc();
+
+    if(!telemetry->timer)
+        return XUD_RES_ERR;
+
+    telemetry->period = period_us * PLATFORM_REFERENCE_MHZ;
+    telemetry->sampleTime = get_reference_time() + telemetry->period;
+    telemetry->epCount = epCount;
+    telemetry->lastDropped = XUD_Tap_GetDropped();
+
+    for(unsigned i = 0; i < epCount; i++)
+    {
+        telemetry->epAddresses[i] = epAddresses[i];
+        telemetry->lastNaks[i] = naks[EpIndex(epAddresses[i])];
+        XUD_Tap_Enable(epAddresses[i], 1);
+    }
+
+    return XUD_RES_OKAY;
+}
+
+void XUD_Telemetry_Free(XUD_Telemetry_t *telemetry)
+{
+    hwtimer_free(telemetry->timer);
+    telemetry->timer = 0;
+}
+
+void XUD_Telemetry_Sample(XUD_Telemetry_t *telemetry, XUD_TelemetrySample_t *sample)
+{
+    volatile unsigned *naks = g_xudNakCount;
+    volatile unsigned *sofMin = &g_xudSofIntervalMin;
+    volatile unsigned *sofMax = &g_xudSofIntervalMax;
+    volatile unsigned *ready = epAddr_Ready;
+
+    const unsigned epCount = telemetry->epCount;
+    const unsigned sampleTime = telemetry->sampleTime;
+
+    XUD_TapDesc_t desc;
+    const hwtimer_t t = telemetry->timer;
+
+    for(unsigned i = 0; i < epCount; i++)
+    {
+        sample->bytes[i] = 0;
+        sample->packets[i] = 0;
+    }
+
+    /* Drain tap descriptors until the end of the period, sleeping on the timer whilst there are none */
+    while(1)
+    {
+        while(XUD_Tap_Read(&desc, 0, 0))
+        {
+            for(unsigned i = 0; i < epCount; i++)
+            {
+                if(telemetry->epAddresses[i] == desc.epAddress)
+                {
+                    sample->bytes[i] += desc.length;
+                    sample->packets[i]++;
+                    break;
+                }
+            }
+        }
+
+        unsigned now = hwtimer_get_time(t);
+
+        if((int)(now - sampleTime) >= 0)
+            break;
+
+        unsigned wake = now + (XUD_TELEMETRY_POLL_us * PLATFORM_REFERENCE_MHZ);
+
+        if((int)(wake - sampleTime) > 0)
+            wake = sampleTime;
+
+        hwtimer_wait_until(t, wake);
+    }
+
+    telemetry->sampleTime += telemetry->period;
+
+    sample->speed = g_curSpeed;
+
+    sample->readyCount = 0;
+    for(unsigned i = 0; i < USB_MAX_NUM_EP; i++)
+    {
+        sample->readyCount += (ready[i] != 0);
+    }
+
+    /* SOF interval tracking restarts each period */
+    sample->sofIntervalMin = *sofMin;
+    sample->sofIntervalMax = *sofMax;
+    *sofMax = 0;
+    *sofMin = 0xFFFFFFFF;
+
+    unsigned dropped = XUD_Tap_GetDropped();
+    sample->dropped = dropped - telemetry->lastDropped;
+    telemetry->lastDropped = dropped;
+
+    for(unsigned i = 0; i < epCount; i++)
+    {
+        unsigned n = naks[EpIndex(telemetry->epAddresses[i])];
+        sample->naks[i] = n - telemetry->lastNaks[i];
+        telemetry->lastNaks[i] = n;
+    }
+}
+
+void XUD_Telemetry(unsigned period_us, unsigned probeBase, unsigned epAddresses[], unsigned epCount)
+{
+    XUD_Telemetry_t telemetry;
+    XUD_TelemetrySample_t sample;
+
+    if(XUD_Telemetry_Init(&telemetry, period_us, epAddresses, epCount) != XUD_RES_OKAY)
+        return;
+
+    while(1)
+    {
+        XUD_Telemetry_Sample(&telemetry, &sample);
+
+        unsigned jitter = 0;
+        if(sample.sofIntervalMax >= sample.sofIntervalMin)
+        {
+            jitter = sample.sofIntervalMax - sample.sofIntervalMin;
+        }
+
+        xscope_int(probeBase + XUD_TELEMETRY_PROBE_SPEED, sample.speed);
+        xscope_int(probeBase + XUD_TELEMETRY_PROBE_READY, sample.readyCount);
+        xscope_int(probeBase + XUD_TELEMETRY_PROBE_SOF_JITTER, jitter);
+        xscope_int(probeBase + XUD_TELEMETRY_PROBE_DROPPED, sample.dropped);
+
+        for(unsigned i = 0; i < epCount; i++)
+        {
+            unsigned tokens = sample.naks[i] + sample.packets[i];
+
+            xscope_int(probeBase + XUD_TELEMETRY_PROBE_EP + (2 * i), sample.bytes[i]);
+            xscope_int(probeBase + XUD_TELEMETRY_PROBE_EP + (2 * i) + 1, tokens ? (sample.naks[i] * 1000) / tokens : 0);
+        }
+    }
+}
+
+#endif
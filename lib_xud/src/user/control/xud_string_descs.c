@@ -0,0 +1,83 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+/**
+ * @brief      Ready to send (UTF-16) string descriptors. See xud_device.h for documentation.
+ */
+#include <string.h>
+#include "xud_device.h"
+#include "xud_string_descs.h"
+
+/* Descriptors are stored back to back, each starting word aligned as required by XUD_SetBuffer() */
+#define STR_DESC_SPAN(bLength) (((bLength) + 3) & ~3)
+
+/* buffer holds an index of descriptor offsets (one word per string) followed by the descriptors */
+static unsigned char *g_strDescTable;
+static unsigned g_strDescCount;
+
+unsigned USB_InitStringDescriptors(char *strDescs[], int strDescsLength, unsigned char buffer[], unsigned bufferSize)
+{
+    unsigned *index = (unsigned *) buffer;
+    unsigned used = strDescsLength * sizeof(unsigned);
+
+    g_strDescCount = 0;
+
+    if(used > bufferSize)
+    {
+        return 0;
+    }
+
+    for(int i = 0; i < strDescsLength; i++)
+    {
+        unsigned length = strlen(strDescs[i]);
+
+        /* String 0 (LangIDs) is a special case, copied as is */
+        if(i != 0)
+        {
+            length <<= 1;
+        }
+
+        /* bLength is a single byte */
+        if(((length + 2) > 255) || ((used + STR_DESC_SPAN(length + 2)) > bufferSize))
+        {
+            return 0;
+        }
+
+        unsigned char *desc = &buffer[used];
+        index[i] = used;
+
+        desc[0] = length + 2;
+        desc[1] = USB_DESCTYPE_STRING;
+
+        for(unsigned j = 0; j < length; j++)
+        {
+            if(i == 0)
+            {
+                desc[j + 2] = strDescs[i][j];
+            }
+            else
+            {
+                desc[j + 2] = (j & 1) ? 0 : strDescs[i][j >> 1];
+            }
+        }
+
+        used += STR_DESC_SPAN(length + 2);
+    }
+
+    g_strDescTable = buffer;
+    g_strDescCount = strDescsLength;
+
+    return used;
+}
+
+unsigned USB_GetStringDescriptorCount(void)
+{
+    return g_strDescCount;
+}
+
+XUD_Result_t USB_SendStringDescriptor(XUD_ep ep_out, XUD_ep ep_in, unsigned stringID, unsigned requested)
+{
+    /* Word aligned and ready to send, so sent in place */
+    unsigned char *desc = &g_strDescTable[((unsigned *) g_strDescTable)[stringID]];
+
+    return XUD_DoGetRequest(ep_out, ep_in, desc, desc[0], requested);
+}
@@ -0,0 +1,17 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+/**
+ * @brief      String descriptors converted by USB_InitStringDescriptors(), served by USB_StandardRequests()
+ */
+#ifndef _XUD_STRING_DESCS_H_
+#define _XUD_STRING_DESCS_H_
+
+#include "xud.h"
+
+/* Number of converted string descriptors, 0 if USB_InitStringDescriptors() has not been used */
+unsigned USB_GetStringDescriptorCount(void);
+
+/* Sends converted string descriptor stringID (must be less than USB_GetStringDescriptorCount()) */
+XUD_Result_t USB_SendStringDescriptor(XUD_ep ep_out, XUD_ep ep_in, unsigned stringID, unsigned requested);
+
+#endif
@@ -22,7 +22,8 @@ XN_FILES = [
 combine_test = combine_process(os.path.dirname(os.path.abspath(__file__)))
 xcov_comb = xcov_combine()
 
-# Note, HS tests will be skipped unless 85MIPS are available to lib_xud
+# Note, HS tests will be skipped unless 85MIPS are available to lib_xud. See
+# benchmarks/run_cycle_budget.py for the per path requirement
 PARAMS = {
     "extended": {
         "arch": ["xs3"],
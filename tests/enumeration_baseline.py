@@ -0,0 +1,159 @@
+#!/usr/bin/env python
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+""" Enumeration time baseline from the host model
+
+Runs the UsbEnumeration host model of test_enumeration against an ideal device
+without xsim. The device answers every token after a fixed turnaround and never
+NAKs, so the time reported is the part of the enumeration set by the host
+(inter-request and inter-transaction delays, SET_ADDRESS recovery, NAK free
+packet times). This is NOT a measurement of XUD. The time the DUT spends
+preparing each response is not included, MAX_ENUMERATION_TIME_US in
+test_enumeration.py adds a margin over this baseline to cover it.
+
+    python enumeration_baseline.py
+"""
+
+import json
+import struct
+
+import usb_enumeration
+from test_enumeration import (
+    CONFIG_DESCRIPTOR,
+    DEVICE_DESCRIPTOR,
+    NEW_ADDRESS,
+    STRINGS,
+)
+from usb_host import (
+    USB_DESC_CONFIGURATION,
+    USB_DESC_DEVICE,
+    USB_DESC_STRING,
+    USB_REQ_GET_DESCRIPTOR,
+    UsbHost,
+)
+from usb_packet import RXA_START_DELAY, USB_DATA_VALID_COUNT, USB_PID
+
+FS_PER_US = 1000 * 1000 * 1000
+CLOCK_PERIOD_FS = FS_PER_US / 60
+
+# Ideal device turnaround, token end to response start (USB clocks)
+DEVICE_RESPONSE_CLOCKS = 8
+
+LANGID_DESCRIPTOR = [0x04, USB_DESC_STRING, 0x09, 0x04]
+
+
+class ModelPhy:
+    """Stands in for UsbPhy, keeping time but driving no pins"""
+
+    def __init__(self):
+        self.xsi = self
+        self._time = 0
+
+    def get_time(self):
+        return self._time
+
+    def clocks(self, count):
+        self._time += count * CLOCK_PERIOD_FS
+
+    def wait_for_clocks(self, clockCount):
+        self.clocks(clockCount + 1)
+
+    def wait_until(self, time):
+        self._time = max(self._time, time)
+
+
+class IdealDeviceHost(UsbHost):
+    """UsbHost whose packets are answered by an ideal device model. Packet
+    times follow TxPacket.drive() and RxPacket.receive()"""
+
+    def __init__(self, usb_phy, bus_speed, **kwargs):
+        super().__init__(usb_phy, bus_speed, **kwargs)
+        self._token = None
+        self._setup = None
+        self._inData = []
+        self._inPid = USB_PID["DATA1"]
+
+    def _tx_clocks(self, nbytes, delay):
+        count = USB_DATA_VALID_COUNT[self._bus_speed]
+        self._usb_phy.wait_for_clocks(delay)
+        self._usb_phy.clocks(RXA_START_DELAY[self._bus_speed] * count - 1)
+        self._usb_phy.clocks((nbytes - 1) * count + count - count // 2)
+
+    def _send_token(self, pid, ep):
+        self._token = pid
+        self._tx_clocks(3, self.interTransactionDelay)
+
+    def _send_data(self, pid, data):
+        if self._token == "SETUP":
+            self._setup = bytes(data)
+            self._start_request()
+        self._tx_clocks(len(data) + 3, 0)
+
+    def _send_ack(self):
+        self._tx_clocks(1, 0)
+
+    def _start_request(self):
+        bmRequestType, bRequest, wValue, wIndex, wLength = struct.unpack(
+            "<BBHHH", self._setup
+        )
+        self._inPid = USB_PID["DATA1"]
+        self._inData = []
+        if bmRequestType == 0x80 and bRequest == USB_REQ_GET_DESCRIPTOR:
+            descType, index = wValue >> 8, wValue & 0xFF
+            if descType == USB_DESC_DEVICE:
+                desc = DEVICE_DESCRIPTOR
+            elif descType == USB_DESC_CONFIGURATION:
+                desc = CONFIG_DESCRIPTOR
+            elif index == 0:
+                desc = LANGID_DESCRIPTOR
+            else:
+                string = STRINGS[index].encode("utf-16-le")
+                desc = [2 + len(string), USB_DESC_STRING] + list(string)
+            self._inData = list(desc[:wLength])
+
+    def _receive(self):
+        count = USB_DATA_VALID_COUNT[self._bus_speed]
+        self._usb_phy.clocks(DEVICE_RESPONSE_CLOCKS)
+
+        if self._token == "IN":
+            mps = self.maxPacketSize[0]
+            payload, self._inData = self._inData[:mps], self._inData[mps:]
+            rx = [self._inPid] + payload + [0, 0]
+            if self._inPid == USB_PID["DATA1"]:
+                self._inPid = USB_PID["DATA0"]
+            else:
+                self._inPid = USB_PID["DATA1"]
+        else:
+            rx = [USB_PID["ACK"]]
+
+        self.responseClocks = DEVICE_RESPONSE_CLOCKS
+        self._usb_phy.clocks(len(rx) * count)
+        return rx
+
+
+def main():
+    usb_enumeration.UsbHost = IdealDeviceHost
+
+    results = {}
+    for bus_speed in ["HS", "FS"]:
+        enumeration = usb_enumeration.UsbEnumeration(
+            device_address=NEW_ADDRESS,
+            interRequestDelay=500,
+            devDesc=DEVICE_DESCRIPTOR,
+            cfgDesc=CONFIG_DESCRIPTOR,
+            strings=STRINGS,
+        )
+        enumeration.drive(ModelPhy(), bus_speed)
+        results[bus_speed] = {
+            "total_time_us": round(enumeration.total_time_us, 1),
+            "requests": [
+                {"request": name, "latency_us": round(latency, 2)}
+                for name, latency in enumeration.latency_us
+            ],
+        }
+
+    print(json.dumps(results, indent=4))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,53 @@
+#!/usr/bin/env python
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+""" Calibrate the test_enumeration time limit from an xsim run
+
+Reads the enumeration reports written to logs/ by a run of test_enumeration
+under xsim and writes the limit used by the test to enumeration_limits.json.
+The limit for each bus speed is the slowest measured enumeration across all
+core frequencies and thread counts plus CALIBRATION_MARGIN. Run the test with
+--extended first so every parameter set is covered:
+
+    pytest -k test_enumeration --extended
+    python enumeration_calibrate.py
+"""
+
+import glob
+import json
+import sys
+
+from test_enumeration import ENUMERATION_LIMITS_FILE
+
+# Headroom over the slowest measured enumeration
+CALIBRATION_MARGIN = 0.2
+
+
+def main():
+    measured = {}
+    for report in glob.glob("logs/enumeration_*.json"):
+        with open(report) as f:
+            result = json.load(f)
+        bus_speed = result["bus_speed"]
+        measured[bus_speed] = max(measured.get(bus_speed, 0), result["total_time_us"])
+
+    if not measured:
+        print("No enumeration reports in logs/, run test_enumeration first")
+        sys.exit(1)
+
+    limits = {
+        bus_speed: {
+            "measured_us": round(time_us, 1),
+            "limit_us": round(time_us * (1 + CALIBRATION_MARGIN)),
+        }
+        for bus_speed, time_us in measured.items()
+    }
+
+    with open(ENUMERATION_LIMITS_FILE, "w") as f:
+        json.dump(limits, f, indent=4)
+
+    print(json.dumps(limits, indent=4))
+
+
+if __name__ == "__main__":
+    main()
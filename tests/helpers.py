@@ -1,8 +1,10 @@
 #!/usr/bin/env python
 # Copyright 2016-2022 XMOS LIMITED.
 # This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import json
 import os
 import sys
+import time
 
 from Pyxsim import testers
 from usb_clock import Clock
@@ -173,17 +175,30 @@ def do_usb_test(
 
             simargs = get_sim_args(testname, desc)
             simthreads = [clk, phy] + extra_tasks
-            return Pyxsim.run_on_simulator_(
+            start = time.perf_counter()
+            result = Pyxsim.run_on_simulator_(
                 binary,
                 simthreads=simthreads,
                 tester=tester,
                 simargs=simargs,
                 capfd=capfd,
             )
+            record_wall_time(testname, desc, time.perf_counter() - start)
+            return result
     else:
         return False
 
 
+def record_wall_time(testname, desc, seconds):
+    """Record the wall time of a simulation run to logs/ so that runs of the
+    harness before and after a change can be compared"""
+
+    log_folder = create_if_needed("logs")
+    filename = f"{log_folder}/walltime_{testname}_{desc}.json"
+    with open(filename, "w") as f:
+        json.dump({"test": testname, "desc": desc, "wall_time_s": seconds}, f)
+
+
 def create_expect(session, filename, verbose=False):
     """Create the expect file for what packets should be reported by the DUT"""
 
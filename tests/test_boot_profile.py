@@ -0,0 +1,118 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import json
+import struct
+import sys
+from copy import deepcopy
+
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from helpers import create_if_needed
+from usb_event import UsbEvent
+from usb_host import UsbHost, UsbTransferError
+from usb_session import UsbSession
+from usb_transaction import UsbTransaction
+from usb_signalling import UsbDeviceAttach
+
+# Boot to configured benchmark, only on EP 0
+PARAMS = deepcopy(PARAMS)
+for k in PARAMS:
+    PARAMS[k].update({"ep": [0], "address": [1]})
+
+# Must match XUD_BootStage_t, followed by SET_CONFIGURATION complete
+STAGES = ["main", "ep_setup", "usb_clock", "bus_reset", "speed", "configured"]
+
+TICKS_PER_US = 100
+
+
+class UsbBootProfileReport(UsbEvent):
+    """Reads the boot profile from the DUT with a vendor request and reports it.
+    The report goes to a log file and stderr, so the expected output is unchanged"""
+
+    def __init__(self, address, report):
+        self._address = address
+        self._report = report
+        super().__init__()
+
+    @property
+    def event_count(self):
+        return 0
+
+    def expected_output(self, bus_speed, offset=0):
+        return ""
+
+    def drive(self, usb_phy, bus_speed):
+
+        host = UsbHost(usb_phy, bus_speed, address=self._address, quiet=True)
+
+        # Vendor, device to host
+        setup = struct.pack("<BBHHH", 0xC0, 0x00, 0, 0, 4 * len(STAGES))
+
+        try:
+            data = host.run(host.control_transfer(setup))
+        except UsbTransferError as e:
+            print("ERROR: Boot profile request failed with status {}".format(e.status))
+            return
+
+        ticks = struct.unpack("<{}I".format(len(STAGES)), bytes(data))
+        profile_us = {s: t / TICKS_PER_US for s, t in zip(STAGES, ticks)}
+
+        with open(self._report, "w") as f:
+            json.dump({"bus_speed": bus_speed, "profile_us": profile_us}, f, indent=4)
+
+        print(
+            "Boot profile ({}): ".format(bus_speed)
+            + ", ".join("{} {:.1f}us".format(s, t) for s, t in profile_us.items()),
+            file=sys.stderr,
+        )
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed, core_freq, dummy_threads):
+
+    initial_delay = 22000
+
+    ied = 500
+
+    session = UsbSession(
+        bus_speed=bus_speed,
+        run_enumeration=False,
+        device_address=address,
+        initial_delay=initial_delay * 1000 * 1000,  # fS
+    )
+
+    session.add_event(UsbDeviceAttach())
+
+    # SET_CONFIGURATION: SETUP followed by a 0 length IN status stage
+    session.add_event(
+        UsbTransaction(
+            session,
+            deviceAddress=address,
+            endpointNumber=ep,
+            endpointType="CONTROL",
+            transType="SETUP",
+            dataLength=8,
+            interEventDelay=ied,
+        )
+    )
+
+    session.add_event(
+        UsbTransaction(
+            session,
+            deviceAddress=address,
+            endpointNumber=ep,
+            endpointType="CONTROL",
+            transType="IN",
+            dataLength=0,
+            interEventDelay=ied,
+        )
+    )
+
+    report = "{}/boot_profile_{}_{}_{}.json".format(
+        create_if_needed("logs"), core_freq, dummy_threads, bus_speed
+    )
+
+    session.add_event(UsbBootProfileReport(address, report))
+
+    return session
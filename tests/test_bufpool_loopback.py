@@ -0,0 +1,149 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import json
+from copy import deepcopy
+
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from helpers import create_if_needed
+from usb_event import UsbEvent
+from usb_session import UsbSession
+from usb_transaction import UsbTransaction
+
+# One extra thread used by the test for the second loopback task
+PARAMS = deepcopy(PARAMS)
+for k in PARAMS:
+    PARAMS[k].update({"dummy_threads": [3]})
+
+# Must match test Makefile and source. The OUT stream is longer than the pool so
+# the DUT runs out of buffers and must wait for the IN side to release them
+POOL_COUNT = 16
+PKT_COUNT = POOL_COUNT + 4
+
+# Max bulk packet size per bus speed
+PKT_LENGTH = {"HS": 512, "FS": 64}
+
+# Gap between max size bulk transactions (USB clocks). Each transaction occupies
+# ~530 clocks at HS, so this sustains ~90% of the raw bus rate
+INTER_TRANSACTION_DELAY = 60
+
+# Time for the DUT to pick up a released buffer and re-arm its OUT endpoint
+REARM_DELAY = 1000
+
+FS_PER_US = 1000 * 1000 * 1000
+
+# Raw bus data rate (MBytes/s) and the fraction of it a burst must sustain. The
+# host spacing above allows ~90%, the margin covers token and handshake overhead
+BUS_MBYTES_PER_SEC = {"HS": 60.0, "FS": 1.5}
+MIN_BUS_FRACTION = 0.75
+
+
+class UsbThroughputMark(UsbEvent):
+    """Marks the start or end of a burst of packets. The end mark writes the
+    data rate sustained over the burst to a report and fails the test if it is
+    below MIN_BUS_FRACTION of the raw bus rate"""
+
+    def __init__(self, start=None, nbytes=0, report=None):
+        self._start = start
+        self._nbytes = nbytes
+        self._report = report
+        self.timestamp = None
+        super().__init__()
+
+    @property
+    def event_count(self):
+        return 0
+
+    def expected_output(self, bus_speed, offset=0):
+        return ""
+
+    def drive(self, usb_phy, bus_speed):
+        self.timestamp = usb_phy.xsi.get_time()
+
+        if self._start is None:
+            return
+
+        elapsed_us = (self.timestamp - self._start.timestamp) / FS_PER_US
+        rate = self._nbytes / elapsed_us
+        with open(self._report, "w") as f:
+            json.dump(
+                {
+                    "bus_speed": bus_speed,
+                    "bytes": self._nbytes,
+                    "elapsed_us": elapsed_us,
+                    "mbytes_per_sec": rate,
+                },
+                f,
+                indent=4,
+            )
+
+        min_rate = BUS_MBYTES_PER_SEC[bus_speed] * MIN_BUS_FRACTION
+        if rate < min_rate:
+            print(
+                "ERROR: Sustained {:.2f}MBytes/s, limit {:.2f}MBytes/s".format(
+                    rate, min_rate
+                )
+            )
+
+
+def add_transactions(session, address, ep, bus_speed, transType, count, delay):
+    for _ in range(count):
+        session.add_event(
+            UsbTransaction(
+                session,
+                deviceAddress=address,
+                endpointNumber=ep,
+                endpointType="BULK",
+                transType=transType,
+                dataLength=PKT_LENGTH[bus_speed],
+                interEventDelay=delay,
+            )
+        )
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed, core_freq, dummy_threads):
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    report = "{}/bufpool_throughput_{}_{}_{}_{{}}.json".format(
+        create_if_needed("logs"), core_freq, dummy_threads, bus_speed
+    )
+
+    # Stream of max size packets in until the pool is full, followed by the
+    # same data back out. The DUT forwards every OUT buffer to the IN endpoint
+    # by handle, without copying. The throughput sustained by each burst is
+    # reported
+    start = UsbThroughputMark()
+    session.add_event(start)
+    add_transactions(
+        session, address, ep, bus_speed, "OUT", POOL_COUNT, INTER_TRANSACTION_DELAY
+    )
+    session.add_event(
+        UsbThroughputMark(
+            start, POOL_COUNT * PKT_LENGTH[bus_speed], report.format("out")
+        )
+    )
+
+    # Each further OUT needs a buffer released by an IN first
+    for _ in range(PKT_COUNT - POOL_COUNT):
+        add_transactions(
+            session, address, ep, bus_speed, "IN", 1, INTER_TRANSACTION_DELAY
+        )
+        add_transactions(session, address, ep, bus_speed, "OUT", 1, REARM_DELAY)
+
+    start = UsbThroughputMark()
+    session.add_event(start)
+    add_transactions(
+        session, address, ep, bus_speed, "IN", POOL_COUNT, INTER_TRANSACTION_DELAY
+    )
+    session.add_event(
+        UsbThroughputMark(
+            start, POOL_COUNT * PKT_LENGTH[bus_speed], report.format("in")
+        )
+    )
+
+    return session
@@ -0,0 +1,38 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from usb_session import UsbSession
+from usb_transaction import UsbTransaction
+
+# Must match test source
+START_LENGTH = 10
+END_LENGTH = 20
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed):
+
+    interEventDelay = 500
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    # DUT loops each packet back with XUD_GetBuffer_Inline()/XUD_SetBuffer_Inline()
+    for pktLength in range(START_LENGTH, END_LENGTH + 1):
+        for transType in ["OUT", "IN"]:
+            session.add_event(
+                UsbTransaction(
+                    session,
+                    deviceAddress=address,
+                    endpointNumber=ep,
+                    endpointType="BULK",
+                    transType=transType,
+                    dataLength=pktLength,
+                    interEventDelay=interEventDelay,
+                )
+            )
+
+    return session
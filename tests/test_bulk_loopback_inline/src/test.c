@@ -0,0 +1,44 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include "xud.h"
+#include "test.h"
+#include "xud_shared.h"
+
+/* Must match test_bulk_loopback_inline.py */
+#define PKT_LEN_START      (10)
+#define PKT_LEN_END        (20)
+
+/* Loops back packets of increasing length using the inline transfer functions */
+unsigned test_func(chanend c_ep_out[EP_COUNT_OUT], chanend c_ep_in[EP_COUNT_IN])
+{
+    unsigned char buffer[1024];
+    unsigned length;
+    XUD_Result_t result;
+
+    XUD_ep ep_out = XUD_InitEp(c_ep_out[TEST_EP_NUM]);
+    XUD_ep ep_in = XUD_InitEp(c_ep_in[TEST_EP_NUM]);
+
+    for(unsigned expected = PKT_LEN_START; expected <= PKT_LEN_END; expected++)
+    {
+        result = XUD_GetBuffer_Inline(ep_out, buffer, &length);
+
+        if((result != XUD_RES_OKAY) || (length != expected))
+        {
+            printstr("#### Bad OUT packet, length: ");
+            printintln(length);
+            return 1;
+        }
+
+        /* Host checks the data looped back */
+        result = XUD_SetBuffer_Inline(ep_in, buffer, length);
+
+        if(result != XUD_RES_OKAY)
+        {
+            printstr("#### Bad IN packet, length: ");
+            printintln(length);
+            return 1;
+        }
+    }
+
+    return 0;
+}
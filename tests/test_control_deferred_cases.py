@@ -0,0 +1,104 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import struct
+from copy import deepcopy
+
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from usb_event import UsbEvent
+from usb_host import EPIPE, UsbHost, UsbTransferError
+from usb_session import UsbSession
+
+# Only test on EP 0 - Update params
+PARAMS = deepcopy(PARAMS)
+for k in PARAMS:
+    PARAMS[k].update({"ep": [0]})
+
+# Must match test source
+REQ_IN = 1
+REQ_STALL = 2
+REQ_SLOW = 3
+REQ_SUPERSEDE = 4
+
+IN_LENGTH = 10
+
+# Status stage polls of the slow request before the host abandons it
+SLOW_POLLS = 3
+
+# Gives the DUT time to mark EP 0 ready for the next SETUP
+REQUEST_GAP_CLOCKS = 2000
+
+
+class UsbDeferredRequests(UsbEvent):
+    """Deferred requests with a device to host data stage, a STALLed status stage
+    and a request superseded by a new SETUP whilst deferred"""
+
+    def __init__(self, address):
+        self._address = address
+        super().__init__()
+
+    @property
+    def event_count(self):
+        return 0
+
+    def expected_output(self, bus_speed, offset=0):
+        return "Deferred requests checked\n"
+
+    def __str__(self):
+        return "UsbDeferredRequests"
+
+    def drive(self, usb_phy, bus_speed):
+
+        host = UsbHost(usb_phy, bus_speed, address=self._address, quiet=True)
+
+        # Vendor requests, device to host then host to device without data
+        inSetup = struct.pack("<BBHHH", 0xC0, REQ_IN, 0, 0, IN_LENGTH)
+        stallSetup = struct.pack("<BBHHH", 0x40, REQ_STALL, 0, 0, 0)
+        slowSetup = struct.pack("<BBHHH", 0x40, REQ_SLOW, 0, 0, 0)
+        supersedeSetup = struct.pack("<BBHHH", 0x40, REQ_SUPERSEDE, 0, 0, 0)
+
+        try:
+            usb_phy.wait_for_clocks(REQUEST_GAP_CLOCKS)
+
+            data = host.run(host.control_transfer(inSetup))
+            if data != list(range(IN_LENGTH)):
+                print("ERROR: Deferred IN data mismatch: {}".format(data))
+
+            usb_phy.wait_for_clocks(REQUEST_GAP_CLOCKS)
+
+            try:
+                host.run(host.control_transfer(stallSetup))
+                print("ERROR: Failed deferred request not STALLed")
+            except UsbTransferError as e:
+                if e.status != -EPIPE:
+                    raise
+
+            usb_phy.wait_for_clocks(REQUEST_GAP_CLOCKS)
+
+            # Status stage is NAKed whilst deferred, abandon it for a new request
+            slow = host.control_transfer(slowSetup)
+            for _ in range(SLOW_POLLS):
+                next(slow)
+                usb_phy.wait_for_clocks(REQUEST_GAP_CLOCKS)
+            slow.close()
+
+            host.run(host.control_transfer(supersedeSetup))
+
+        except (UsbTransferError, StopIteration) as e:
+            print("ERROR: Deferred requests failed: {}".format(e))
+            return
+
+        print("Deferred requests checked")
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed):
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    session.add_event(UsbDeferredRequests(address))
+
+    return session
@@ -0,0 +1,74 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+from copy import deepcopy
+
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from usb_packet import (
+    TokenPacket,
+    TxDataPacket,
+    RxDataPacket,
+    TxHandshakePacket,
+    RxHandshakePacket,
+    USB_PID,
+)
+from usb_session import UsbSession
+
+# Only test on EP 0 - Update params
+PARAMS = deepcopy(PARAMS)
+for k in PARAMS:
+    PARAMS[k].update({"ep": [0]})
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed):
+
+    ied = 500
+    newAddress = (address + 1) % 128
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    # SET_ADDRESS
+    session.add_event(
+        TokenPacket(
+            pid=USB_PID["SETUP"],
+            address=address,
+            endpoint=ep,
+            interEventDelay=ied,
+        )
+    )
+    session.add_event(
+        TxDataPacket(
+            dataPayload=[0x00, 5, newAddress, 0, 0, 0, 0, 0],
+            pid=USB_PID["DATA0"],
+        )
+    )
+    session.add_event(RxHandshakePacket())
+
+    # Status stage, still at the old address
+    session.add_event(
+        TokenPacket(
+            pid=USB_PID["IN"],
+            address=address,
+            endpoint=ep,
+            interEventDelay=1000,
+        )
+    )
+    session.add_event(RxDataPacket(dataPayload=[], pid=USB_PID["DATA1"]))
+    session.add_event(TxHandshakePacket())
+
+    # First token to the new address immediately after the ACK. EP0 is not
+    # ready so expect NAK (the DUT would not respond at the wrong address)
+    session.add_event(
+        TokenPacket(
+            pid=USB_PID["IN"],
+            address=newAddress,
+            endpoint=ep,
+        )
+    )
+    session.add_event(RxHandshakePacket(pid=USB_PID["NAK"]))
+
+    return session
@@ -0,0 +1,53 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+from copy import deepcopy
+
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from usb_session import UsbSession
+from usb_transaction import UsbTransaction
+
+# Only test on EP 0 - Update params
+PARAMS = deepcopy(PARAMS)
+for k in PARAMS:
+    PARAMS[k].update({"ep": [0]})
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed):
+
+    ied = 500
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    # First SETUP received directly, then back-to-back SETUPs whilst EP0 is busy.
+    # All must be ACKed, the DUT should then be given the newest
+    for i in range(3):
+        session.add_event(
+            UsbTransaction(
+                session,
+                deviceAddress=address,
+                endpointNumber=ep,
+                endpointType="CONTROL",
+                transType="SETUP",
+                dataLength=8,
+                interEventDelay=ied,
+            )
+        )
+
+    # Expect 0 length IN transaction
+    session.add_event(
+        UsbTransaction(
+            session,
+            deviceAddress=address,
+            endpointNumber=ep,
+            endpointType="CONTROL",
+            transType="IN",
+            dataLength=0,
+            interEventDelay=ied,
+        )
+    )
+    return session
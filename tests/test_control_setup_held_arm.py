@@ -0,0 +1,70 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+from copy import deepcopy
+
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from usb_session import UsbSession
+from usb_transaction import UsbTransaction
+
+# Only test on EP 0 at HS, the sweep below is timed for HS packets
+PARAMS = deepcopy(PARAMS)
+for k in PARAMS:
+    PARAMS[k].update({"ep": [0], "bus_speed": ["HS"]})
+
+# Gap between the first two SETUPs of a round (USB clocks), the second is held
+HELD_DELAY = 500
+
+# Gap from the held SETUP to the third SETUP of a round (USB clocks). Stepped
+# across the time the DUT arms EP0 (BUSY_TICKS after the first SETUP, see test
+# source) so that the third SETUP lands whilst a held SETUP is being armed over
+ARM_DELAY_MIN = 600
+ARM_DELAY_MAX = 760
+ARM_DELAY_STEP = 8
+
+ROUND_DELAY = 3000
+
+
+def add_setup(session, address, ep, delay):
+    session.add_event(
+        UsbTransaction(
+            session,
+            deviceAddress=address,
+            endpointNumber=ep,
+            endpointType="CONTROL",
+            transType="SETUP",
+            dataLength=8,
+            interEventDelay=delay,
+        )
+    )
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed):
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    # Each round: a SETUP taken directly, one held whilst EP0 is busy and one
+    # sent around the time EP0 arms for the next. The DUT must end each round
+    # with the newest SETUP and no stray notification, then sends the status
+    for armDelay in range(ARM_DELAY_MIN, ARM_DELAY_MAX + 1, ARM_DELAY_STEP):
+        add_setup(session, address, ep, ROUND_DELAY)
+        add_setup(session, address, ep, HELD_DELAY)
+        add_setup(session, address, ep, armDelay)
+
+        session.add_event(
+            UsbTransaction(
+                session,
+                deviceAddress=address,
+                endpointNumber=ep,
+                endpointType="CONTROL",
+                transType="IN",
+                dataLength=0,
+                interEventDelay=ROUND_DELAY,
+            )
+        )
+
+    return session
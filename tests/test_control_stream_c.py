@@ -0,0 +1,147 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+from copy import deepcopy
+
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from usb_session import UsbSession
+from usb_transaction import UsbTransaction
+
+# Only test on EP 0 - Update params
+PARAMS = deepcopy(PARAMS)
+for k in PARAMS:
+    PARAMS[k].update({"ep": [0]})
+
+# Must match STREAM_LENGTH in test.c
+STREAM_LENGTH = 150
+EP0_MAX_PACKET_SIZE = 64
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed):
+
+    ied = 500
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    packetLengths = [EP0_MAX_PACKET_SIZE] * (STREAM_LENGTH // EP0_MAX_PACKET_SIZE)
+    packetLengths.append(STREAM_LENGTH % EP0_MAX_PACKET_SIZE)
+
+    # Get request, data stage streamed from the DUT producer
+    session.add_event(
+        UsbTransaction(
+            session,
+            deviceAddress=address,
+            endpointNumber=ep,
+            endpointType="CONTROL",
+            transType="SETUP",
+            dataLength=8,
+            interEventDelay=ied,
+        )
+    )
+
+    for pktLength in packetLengths:
+        session.add_event(
+            UsbTransaction(
+                session,
+                deviceAddress=address,
+                endpointNumber=ep,
+                endpointType="CONTROL",
+                transType="IN",
+                dataLength=pktLength,
+                interEventDelay=ied,
+            )
+        )
+
+    session.add_event(
+        UsbTransaction(
+            session,
+            deviceAddress=address,
+            endpointNumber=ep,
+            endpointType="CONTROL",
+            transType="OUT",
+            dataLength=0,
+            interEventDelay=ied,
+        )
+    )
+
+    # Set request, data stage streamed to the DUT consumer
+    session.add_event(
+        UsbTransaction(
+            session,
+            deviceAddress=address,
+            endpointNumber=ep,
+            endpointType="CONTROL",
+            transType="SETUP",
+            dataLength=8,
+            interEventDelay=ied,
+        )
+    )
+
+    for pktLength in packetLengths:
+        session.add_event(
+            UsbTransaction(
+                session,
+                deviceAddress=address,
+                endpointNumber=ep,
+                endpointType="CONTROL",
+                transType="OUT",
+                dataLength=pktLength,
+                interEventDelay=ied,
+            )
+        )
+
+    session.add_event(
+        UsbTransaction(
+            session,
+            deviceAddress=address,
+            endpointNumber=ep,
+            endpointType="CONTROL",
+            transType="IN",
+            dataLength=0,
+            interEventDelay=ied,
+        )
+    )
+
+    # Get request with an overrunning producer, STALLed. A SETUP clears the STALL
+    session.add_event(
+        UsbTransaction(
+            session,
+            deviceAddress=address,
+            endpointNumber=ep,
+            endpointType="CONTROL",
+            transType="SETUP",
+            dataLength=8,
+            interEventDelay=ied,
+        )
+    )
+
+    session.add_event(
+        UsbTransaction(
+            session,
+            deviceAddress=address,
+            endpointNumber=ep,
+            endpointType="CONTROL",
+            transType="IN",
+            dataLength=0,
+            interEventDelay=ied,
+            halted=True,
+        )
+    )
+
+    session.add_event(
+        UsbTransaction(
+            session,
+            deviceAddress=address,
+            endpointNumber=ep,
+            endpointType="CONTROL",
+            transType="SETUP",
+            dataLength=8,
+            interEventDelay=ied,
+        )
+    )
+
+    return session
@@ -0,0 +1,121 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include "xud.h"
+#include "test.h"
+#include "xud_shared.h"
+
+/* Data stage length, spans several packets and ends with a short packet */
+#define STREAM_LENGTH      (150)
+
+typedef struct
+{
+    unsigned expectedOffset;
+    unsigned char data;         /* Next expected/generated data byte */
+    unsigned error;
+} TestStream_t;
+
+static unsigned Producer(void *user, unsigned offset, unsigned char *buffer, unsigned length)
+{
+    TestStream_t *t = (TestStream_t *) user;
+
+    if(offset != t->expectedOffset)
+        t->error = 1;
+
+    for(unsigned i = 0; i < length; i++)
+        buffer[i] = t->data++;
+
+    t->expectedOffset += length;
+    return length;
+}
+
+/* Writes one byte more than asked for */
+static unsigned OverProducer(void *user, unsigned offset, unsigned char *buffer, unsigned length)
+{
+    return length + 1;
+}
+
+static int Consumer(void *user, unsigned offset, unsigned char *buffer, unsigned length)
+{
+    TestStream_t *t = (TestStream_t *) user;
+
+    if(offset != t->expectedOffset)
+        t->error = 1;
+
+    for(unsigned i = 0; i < length; i++)
+    {
+        if(buffer[i] != t->data++)
+        {
+            printstr("Mismatch:");
+            printhexln(buffer[i]);
+            t->error = 1;
+        }
+    }
+
+    t->expectedOffset += length;
+    return 0;
+}
+
+unsigned test_func(chanend c_ep_out[EP_COUNT_OUT], chanend c_ep_in[EP_COUNT_IN])
+{
+    XUD_ep ep0_out = XUD_InitEp(c_ep_out[0]);
+    XUD_ep ep0_in  = XUD_InitEp(c_ep_in[0]);
+    unsigned char sbuffer[120];
+    unsigned length;
+    unsigned failed = 0;
+
+    /* Only valid bMaxPacketSize0 values are accepted, the current size is kept otherwise */
+    if((XUD_SetEp0MaxPacketSize(0) != XUD_RES_ERR) || (XUD_SetEp0MaxPacketSize(48) != XUD_RES_ERR)
+        || (XUD_SetEp0MaxPacketSize(128) != XUD_RES_ERR) || (XUD_GetEp0MaxPacketSize() != 64))
+    {
+        printstrln("ERROR: Bad EP0 max packet size accepted");
+        failed = 1;
+    }
+
+    /* Get request: IN data generated a packet at a time */
+    TestStream_t get = {0, 0, 0};
+
+    if(XUD_GetSetupBuffer(ep0_out, sbuffer, &length) != XUD_RES_OKAY)
+        failed = 1;
+
+    unsigned requested = sbuffer[6] | (sbuffer[7] << 8);
+
+    if(XUD_DoGetRequestStream(ep0_out, ep0_in, STREAM_LENGTH, requested, Producer, &get) != XUD_RES_OKAY)
+        failed = 1;
+
+    if(get.error || (get.expectedOffset != STREAM_LENGTH))
+        failed = 1;
+
+    /* Set request: OUT data consumed a packet at a time. Host data follows the two SETUPs */
+    TestStream_t set = {0, 16, 0};
+
+    if(XUD_GetSetupBuffer(ep0_out, sbuffer, &length) != XUD_RES_OKAY)
+        failed = 1;
+
+    if(XUD_DoSetRequestStream(ep0_out, ep0_in, STREAM_LENGTH, Consumer, &set) != XUD_RES_OKAY)
+        failed = 1;
+
+    if(set.error || (set.expectedOffset != STREAM_LENGTH))
+        failed = 1;
+
+    /* Get request whose producer overruns the packet, nothing is sent and the request is STALLed */
+    if(XUD_GetSetupBuffer(ep0_out, sbuffer, &length) != XUD_RES_OKAY)
+        failed = 1;
+
+    requested = sbuffer[6] | (sbuffer[7] << 8);
+
+    if(XUD_DoGetRequestStream(ep0_out, ep0_in, STREAM_LENGTH, requested, OverProducer, 0) != XUD_RES_ERR)
+    {
+        printstrln("ERROR: Producer overrun not reported");
+        failed = 1;
+    }
+
+    XUD_SetStall(ep0_out);
+    XUD_SetStall(ep0_in);
+
+    /* Next SETUP clears the STALL */
+    if(XUD_GetSetupBuffer(ep0_out, sbuffer, &length) != XUD_RES_OKAY)
+        failed = 1;
+
+    XUD_Kill(ep0_out);
+    return failed;
+}
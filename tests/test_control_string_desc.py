@@ -0,0 +1,107 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+from copy import deepcopy
+
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from usb_packet import (
+    TokenPacket,
+    TxDataPacket,
+    RxDataPacket,
+    TxHandshakePacket,
+    RxHandshakePacket,
+    USB_PID,
+)
+from usb_session import UsbSession
+
+# Only test on EP 0 - Update params
+PARAMS = deepcopy(PARAMS)
+for k in PARAMS:
+    PARAMS[k].update({"ep": [0]})
+
+# Must match bMaxPacketSize0 of the DUT device descriptor
+EP0_MAX_PACKET_SIZE = 8
+
+# Must match the DUT string table
+STRINGS = ["XMOS", "Product"]
+
+
+def string_descriptor(string):
+    desc = [2 + 2 * len(string), 3]
+    for c in string:
+        desc.extend([ord(c), 0])
+    return desc
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed):
+
+    ied = 500
+    wLength = 255
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    for index, string in enumerate(STRINGS, start=1):
+
+        # GET_DESCRIPTOR(STRING)
+        session.add_event(
+            TokenPacket(
+                pid=USB_PID["SETUP"],
+                address=address,
+                endpoint=ep,
+                interEventDelay=ied,
+            )
+        )
+        session.add_event(
+            TxDataPacket(
+                dataPayload=[0x80, 6, index, 3, 0x09, 0x04, wLength, 0],
+                pid=USB_PID["DATA0"],
+            )
+        )
+        session.add_event(RxHandshakePacket())
+
+        # Data stage split by bMaxPacketSize0 from the device descriptor. The
+        # descriptor is shorter than wLength so a full last packet is followed
+        # by a zero length packet
+        desc = string_descriptor(string)
+        packets = [
+            desc[i : i + EP0_MAX_PACKET_SIZE]
+            for i in range(0, len(desc), EP0_MAX_PACKET_SIZE)
+        ]
+        if len(desc) % EP0_MAX_PACKET_SIZE == 0:
+            packets.append([])
+
+        pid = USB_PID["DATA1"]
+        for packet in packets:
+            session.add_event(
+                TokenPacket(
+                    pid=USB_PID["IN"],
+                    address=address,
+                    endpoint=ep,
+                    interEventDelay=1000,
+                )
+            )
+            session.add_event(RxDataPacket(dataPayload=packet, pid=pid))
+            session.add_event(TxHandshakePacket())
+
+            if pid == USB_PID["DATA1"]:
+                pid = USB_PID["DATA0"]
+            else:
+                pid = USB_PID["DATA1"]
+
+        # Status stage
+        session.add_event(
+            TokenPacket(
+                pid=USB_PID["OUT"],
+                address=address,
+                endpoint=ep,
+                interEventDelay=ied,
+            )
+        )
+        session.add_event(TxDataPacket(dataPayload=[], pid=USB_PID["DATA1"]))
+        session.add_event(RxHandshakePacket())
+
+    return session
@@ -0,0 +1,100 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+from copy import deepcopy
+
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from usb_packet import (
+    TokenPacket,
+    TxDataPacket,
+    RxDataPacket,
+    TxHandshakePacket,
+    RxHandshakePacket,
+    USB_PID,
+)
+from usb_session import UsbSession
+
+# Only test on EP 0 at high-speed, test modes are high-speed only - Update params
+PARAMS = deepcopy(PARAMS)
+for k in PARAMS:
+    PARAMS[k].update({"ep": [0], "bus_speed": ["HS"]})
+
+USB_REQ_SET_ADDRESS = 5
+USB_REQ_SET_FEATURE = 3
+USB_FEATURE_TEST_MODE = 2
+USB_TEST_SE0_NAK = 3
+
+# Time for the DUT to enter test mode after the status stage
+TEST_MODE_ENTRY_DELAY = 5000
+
+
+def no_data_request(session, address, ep, setup):
+    """SETUP and status stage of a host to device request without a data stage"""
+
+    session.add_event(
+        TokenPacket(
+            pid=USB_PID["SETUP"],
+            address=address,
+            endpoint=ep,
+            interEventDelay=500,
+        )
+    )
+    session.add_event(TxDataPacket(dataPayload=setup, pid=USB_PID["DATA0"]))
+    session.add_event(RxHandshakePacket())
+
+    session.add_event(
+        TokenPacket(
+            pid=USB_PID["IN"],
+            address=address,
+            endpoint=ep,
+            interEventDelay=1000,
+        )
+    )
+    session.add_event(RxDataPacket(dataPayload=[], pid=USB_PID["DATA1"]))
+    session.add_event(TxHandshakePacket())
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed):
+
+    newAddress = (address + 1) % 128
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    no_data_request(
+        session, address, ep, [0x00, USB_REQ_SET_ADDRESS, newAddress, 0, 0, 0, 0, 0]
+    )
+
+    # Test mode entered at the new address
+    no_data_request(
+        session,
+        newAddress,
+        ep,
+        [
+            0x00,
+            USB_REQ_SET_FEATURE,
+            USB_FEATURE_TEST_MODE,
+            0,
+            0,
+            USB_TEST_SE0_NAK,
+            0,
+            0,
+        ],
+    )
+
+    # TEST_SE0_NAK: IN tokens to the device's (new) address are NAKed
+    for i in range(2):
+        session.add_event(
+            TokenPacket(
+                pid=USB_PID["IN"],
+                address=newAddress,
+                endpoint=ep,
+                interEventDelay=TEST_MODE_ENTRY_DELAY if i == 0 else 500,
+            )
+        )
+        session.add_event(RxHandshakePacket(pid=USB_PID["NAK"]))
+
+    return session
@@ -0,0 +1,94 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+from copy import deepcopy
+import json
+import os
+
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from helpers import create_if_needed
+from usb_enumeration import UsbEnumeration
+from usb_session import UsbSession
+
+# Enumeration starts from the default address and only uses EP 0
+PARAMS = deepcopy(PARAMS)
+for k in PARAMS:
+    PARAMS[k].update({"ep": [0], "address": [0]})
+
+# Must match the DUT descriptors
+# fmt: off
+DEVICE_DESCRIPTOR = [
+    0x12, 0x01, 0x00, 0x02, 0xFF, 0xFF, 0xFF, 0x40, 0xB1, 0x20,
+    0x01, 0x01, 0x00, 0x10, 0x01, 0x02, 0x00, 0x01,
+]
+
+CONFIG_DESCRIPTOR = [
+    0x09, 0x02, 0x20, 0x00, 0x01, 0x01, 0x00, 0x80, 0xFA,
+    0x09, 0x04, 0x00, 0x00, 0x02, 0xFF, 0xFF, 0xFF, 0x00,
+    0x07, 0x05, 0x01, 0x02, 0x00, 0x02, 0x01,
+    0x07, 0x05, 0x81, 0x02, 0x00, 0x02, 0x01,
+]
+# fmt: on
+
+STRINGS = [None, "XMOS", "Enumeration"]
+
+# Address assigned by the host
+NEW_ADDRESS = 1
+
+# Total enumeration time of the host model below against an ideal device that
+# never NAKs, from enumeration_baseline.py. This covers the host inter-request
+# delays, SET_ADDRESS recovery and packet times only. It is not a measurement
+# of XUD under xsim
+ENUMERATION_BASELINE_US = {"HS": 110.6, "FS": 351.9}
+
+# Margin for the time the DUT takes to prepare its response to each request,
+# which the baseline excludes
+DUT_MARGIN_US_PER_REQUEST = 50
+
+# GET_DESCRIPTOR x 7 (two device, two configuration, three string), SET_ADDRESS
+# and SET_CONFIGURATION
+ENUMERATION_REQUESTS = 9
+
+# Limits calibrated from an xsim run by enumeration_calibrate.py
+ENUMERATION_LIMITS_FILE = os.path.join(
+    os.path.dirname(os.path.abspath(__file__)), "enumeration_limits.json"
+)
+
+# Limit on total enumeration time, fails the test if exceeded. Uses the
+# calibrated limits when present, else the host model baseline plus margin
+if os.path.exists(ENUMERATION_LIMITS_FILE):
+    with open(ENUMERATION_LIMITS_FILE) as f:
+        MAX_ENUMERATION_TIME_US = {k: v["limit_us"] for k, v in json.load(f).items()}
+else:
+    MAX_ENUMERATION_TIME_US = {
+        k: round(v + ENUMERATION_REQUESTS * DUT_MARGIN_US_PER_REQUEST)
+        for k, v in ENUMERATION_BASELINE_US.items()
+    }
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed, core_freq, dummy_threads):
+
+    report = "{}/enumeration_{}_{}_{}.json".format(
+        create_if_needed("logs"), core_freq, dummy_threads, bus_speed
+    )
+
+    enumeration = UsbEnumeration(
+        device_address=NEW_ADDRESS,
+        interRequestDelay=500,
+        devDesc=DEVICE_DESCRIPTOR,
+        cfgDesc=CONFIG_DESCRIPTOR,
+        strings=STRINGS,
+        max_time_us=MAX_ENUMERATION_TIME_US[bus_speed],
+        report=report,
+    )
+
+    session = UsbSession(
+        bus_speed=bus_speed,
+        run_enumeration=True,
+        device_address=NEW_ADDRESS,
+        enumeration=enumeration,
+    )
+
+    return session
@@ -0,0 +1,115 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import struct
+
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from usb_event import UsbEvent
+from usb_host import UsbHost, UsbTransferError
+from usb_session import UsbSession
+
+# Must match test source
+PKT_LENGTH = 10
+PKT_COUNT = 4
+PKT_GAP_CLOCKS = 6000
+
+FS_PER_NS = 1000 * 1000
+
+# DUT timestamps are 100MHz reference timer ticks
+NS_PER_TICK = 10
+
+# Allowed difference between a DUT timestamp delta and the delta between the
+# matching packets on the bus. Covers the IO loop recording the time a few
+# instructions after the handshake
+TOLERANCE_NS = 500
+
+
+class UsbTimestampCheck(UsbEvent):
+    """Sends PKT_COUNT OUT then PKT_COUNT IN packets PKT_GAP_CLOCKS apart,
+    recording the time each completes on the bus. The DUT then returns its
+    endpoint timestamps for each packet in a further IN packet and the deltas
+    between consecutive packets are compared"""
+
+    def __init__(self, address, ep):
+        self._address = address
+        self._ep = ep
+        super().__init__()
+
+    @property
+    def event_count(self):
+        return 0
+
+    def expected_output(self, bus_speed, offset=0):
+        return "Timestamps checked\n"
+
+    def __str__(self):
+        return "UsbTimestampCheck: EP {}".format(self._ep)
+
+    def _check(self, name, hostTimes, dutTimes):
+        for i in range(1, PKT_COUNT):
+            hostDelta = (hostTimes[i] - hostTimes[i - 1]) / FS_PER_NS
+            dutDelta = ((dutTimes[i] - dutTimes[i - 1]) & 0xFFFFFFFF) * NS_PER_TICK
+
+            if abs(dutDelta - hostDelta) > TOLERANCE_NS:
+                print(
+                    "ERROR: {} packet {} timestamp delta {}ns, bus {:.0f}ns".format(
+                        name, i, dutDelta, hostDelta
+                    )
+                )
+
+    def drive(self, usb_phy, bus_speed):
+
+        host = UsbHost(
+            usb_phy,
+            bus_speed,
+            address=self._address,
+            interTransactionDelay=PKT_GAP_CLOCKS,
+            quiet=True,
+        )
+
+        outTimes = []
+        inTimes = []
+        dataCheck = 0
+
+        try:
+            for _ in range(PKT_COUNT):
+                payload = [(dataCheck + x) & 0xFF for x in range(PKT_LENGTH)]
+                dataCheck += PKT_LENGTH
+                host.run(host.out_transfer(self._ep, payload))
+                outTimes.append(usb_phy.xsi.get_time())
+
+            dataCheck = 0
+            for i in range(PKT_COUNT):
+                data = host.run(host.in_transfer(self._ep, PKT_LENGTH))
+                inTimes.append(usb_phy.xsi.get_time())
+
+                expected = [(dataCheck + x) & 0xFF for x in range(PKT_LENGTH)]
+                dataCheck += PKT_LENGTH
+                if data != expected:
+                    print("ERROR: IN packet {} data mismatch".format(i))
+
+            # Recorded OUT then IN timestamps, little-endian
+            data = host.run(host.in_transfer(self._ep, 8 * PKT_COUNT))
+        except UsbTransferError as e:
+            print("ERROR: Transfer failed with status {}".format(e.status))
+            return
+
+        timestamps = struct.unpack("<{}I".format(2 * PKT_COUNT), bytes(data))
+
+        self._check("OUT", outTimes, timestamps[:PKT_COUNT])
+        self._check("IN", inTimes, timestamps[PKT_COUNT:])
+
+        print("Timestamps checked")
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed):
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    session.add_event(UsbTimestampCheck(address, ep))
+
+    return session
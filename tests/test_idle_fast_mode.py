@@ -0,0 +1,56 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+from copy import deepcopy
+
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from usb_packet import CreateSofToken
+from usb_session import UsbSession
+from usb_transaction import UsbTransaction
+
+# DUT provides its own (counting) dummy threads, 5 plus XUD and test thread
+PARAMS = deepcopy(PARAMS)
+for k in PARAMS:
+    PARAMS[k].update({"dummy_threads": [5]})
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed):
+
+    frameNumber = 52
+
+    # Idle time (USB clocks) either side of the SOF, must comfortably exceed
+    # the DUT measurement window (10us)
+    idleDelay = 2000
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    session.add_event(
+        UsbTransaction(
+            session,
+            deviceAddress=address,
+            endpointNumber=ep,
+            endpointType="BULK",
+            transType="OUT",
+            dataLength=10,
+        )
+    )
+
+    session.add_event(CreateSofToken(frameNumber, interEventDelay=idleDelay))
+
+    session.add_event(
+        UsbTransaction(
+            session,
+            deviceAddress=address,
+            endpointNumber=ep,
+            endpointType="BULK",
+            transType="OUT",
+            dataLength=11,
+            interEventDelay=idleDelay,
+        )
+    )
+
+    return session
@@ -0,0 +1,7 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+# Baseline for test_idle_fast_mode: the same DUT and session, built without
+# XUD_IDLE_FAST_MODE_OFF. The DUT checks the dummy threads see no gain after
+# the SOF, so the gain test_idle_fast_mode requires is down to the option
+from conftest import test_RunUsbSession  # noqa F401
+from test_idle_fast_mode import PARAMS, test_session  # noqa F401
@@ -0,0 +1,54 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from usb_session import UsbSession
+from usb_transaction import UsbTransaction
+
+# Must match test source
+PKT_COUNT = 10
+
+# Leave time for the DUT to time each completion before re-arming
+PKT_GAP_CLOCKS = 2000
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed):
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    # DUT compares per-packet client overhead of the out-of-line and inline APIs,
+    # first for the arm and completion calls alone
+    for transType in ["OUT", "IN"]:
+        for i in range(PKT_COUNT):
+            session.add_event(
+                UsbTransaction(
+                    session,
+                    deviceAddress=address,
+                    endpointNumber=ep,
+                    endpointType="BULK",
+                    transType=transType,
+                    dataLength=10 + i,
+                    interEventDelay=PKT_GAP_CLOCKS,
+                )
+            )
+
+    # Then for the full transfer calls, looping each packet back
+    for i in range(PKT_COUNT):
+        for transType in ["OUT", "IN"]:
+            session.add_event(
+                UsbTransaction(
+                    session,
+                    deviceAddress=address,
+                    endpointNumber=ep,
+                    endpointType="BULK",
+                    transType=transType,
+                    dataLength=10 + i,
+                    interEventDelay=PKT_GAP_CLOCKS,
+                )
+            )
+
+    return session
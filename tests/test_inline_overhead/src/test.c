@@ -0,0 +1,178 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xcore/hwtimer.h>
+#include "xud.h"
+#include "test.h"
+#include "xud_shared.h"
+
+/* Must match test_inline_overhead.py */
+#define PKT_COUNT          (10)
+#define PKT_LEN_START      (10)
+
+/* Time allowed for XUD to output a completion once it has cleared the ready entry */
+#define NOTIFY_TICKS       (200)
+
+/* Waits until XUD has completed the transfer the EP is ready for, but does not take the completion */
+static void WaitTransfer(XUD_ep ep)
+{
+    volatile XUD_ep_info *epInfo = (XUD_ep_info *) ep;
+
+    while(*(volatile unsigned *)epInfo->array_ptr);
+
+    unsigned t = get_reference_time();
+    while((get_reference_time() - t) < NOTIFY_TICKS);
+}
+
+/* Fails if the inline total for either direction is not below the out-of-line total */
+static unsigned CheckReduced(const char *name, unsigned ticks[2][2])
+{
+    for(unsigned dir = 0; dir < 2; dir++)
+    {
+        if(ticks[dir][1] >= ticks[dir][0])
+        {
+            printstr("#### Inline ");
+            printstr(name);
+            printstr(" overhead not reduced (ticks): ");
+            printint(ticks[dir][0]);
+            printstr(" -> ");
+            printintln(ticks[dir][1]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Per-packet client overhead (reference timer ticks) of the out-of-line API vs the inline API.
+ * Even packets use the out-of-line functions, odd packets the inline functions.
+ *
+ * The first pass times the arm and completion calls in isolation. The second pass loops each OUT
+ * packet back using the full XUD_GetBuffer()/XUD_SetBuffer() calls or their inline equivalents,
+ * timing each packet from XUD recording it complete (see XUD_GetTimestamp()) to the call
+ * returning */
+unsigned test_func(chanend c_ep_out[EP_COUNT_OUT], chanend c_ep_in[EP_COUNT_IN])
+{
+    unsigned char buffer[1024];
+    unsigned ticks[2][2] = {{0, 0}, {0, 0}}; /* [direction][inline] */
+    unsigned latency[2][2] = {{0, 0}, {0, 0}};
+    unsigned length;
+    XUD_Result_t result;
+    unsigned t0, t1, t2, t3;
+    unsigned char rxCounter = 0;
+    unsigned char txCounter = 0;
+
+    XUD_ep ep_out = XUD_InitEp(c_ep_out[TEST_EP_NUM]);
+    XUD_ep ep_in = XUD_InitEp(c_ep_in[TEST_EP_NUM]);
+
+    for(unsigned i = 0; i < PKT_COUNT; i++)
+    {
+        unsigned useInline = i & 1;
+
+        t0 = get_reference_time();
+        if(useInline)
+            XUD_SetReady_OutPtr(ep_out, (unsigned) buffer);
+        else
+            XUD_SetReady_Out(ep_out, buffer);
+        t1 = get_reference_time();
+
+        WaitTransfer(ep_out);
+
+        t2 = get_reference_time();
+        if(useInline)
+            result = XUD_GetData_Inline(ep_out, &length);
+        else
+            XUD_GetData_Select(c_ep_out[TEST_EP_NUM], ep_out, &length, &result);
+        t3 = get_reference_time();
+
+        if((result != XUD_RES_OKAY) || (length != PKT_LEN_START + i))
+        {
+            printstr("#### Bad OUT packet: ");
+            printintln(i);
+            return 1;
+        }
+
+        for(unsigned j = 0; j < length; j++)
+        {
+            if(buffer[j] != rxCounter++)
+            {
+                printstr("#### Mismatch in OUT packet: ");
+                printintln(i);
+                return 1;
+            }
+        }
+
+        ticks[0][useInline] += (t1 - t0) + (t3 - t2);
+    }
+
+    for(unsigned i = 0; i < PKT_COUNT; i++)
+    {
+        unsigned useInline = i & 1;
+
+        for(unsigned j = 0; j < PKT_LEN_START + i; j++)
+        {
+            buffer[j] = txCounter++;
+        }
+
+        t0 = get_reference_time();
+        XUD_SetReady_In(ep_in, buffer, PKT_LEN_START + i);
+        t1 = get_reference_time();
+
+        WaitTransfer(ep_in);
+
+        t2 = get_reference_time();
+        if(useInline)
+            result = XUD_SetData_Inline(ep_in);
+        else
+            XUD_SetData_Select(c_ep_in[TEST_EP_NUM], ep_in, &result);
+        t3 = get_reference_time();
+
+        if(result != XUD_RES_OKAY)
+        {
+            printstr("#### Bad IN packet: ");
+            printintln(i);
+            return 1;
+        }
+
+        ticks[1][useInline] += (t1 - t0) + (t3 - t2);
+    }
+
+    if(CheckReduced("arm and completion", ticks))
+        return 1;
+
+    for(unsigned i = 0; i < PKT_COUNT; i++)
+    {
+        unsigned useInline = i & 1;
+
+        if(useInline)
+            result = XUD_GetBuffer_Inline(ep_out, buffer, &length);
+        else
+            result = XUD_GetBuffer(ep_out, buffer, &length);
+        t0 = get_reference_time();
+
+        latency[0][useInline] += t0 - XUD_GetTimestamp(ep_out);
+
+        if((result != XUD_RES_OKAY) || (length != PKT_LEN_START + i))
+        {
+            printstr("#### Bad loopback OUT packet: ");
+            printintln(i);
+            return 1;
+        }
+
+        /* Host checks the data looped back */
+        if(useInline)
+            result = XUD_SetBuffer_Inline(ep_in, buffer, length);
+        else
+            result = XUD_SetBuffer(ep_in, buffer, length);
+        t0 = get_reference_time();
+
+        latency[1][useInline] += t0 - XUD_GetTimestamp(ep_in);
+
+        if(result != XUD_RES_OKAY)
+        {
+            printstr("#### Bad loopback IN packet: ");
+            printintln(i);
+            return 1;
+        }
+    }
+
+    return CheckReduced("transfer", latency);
+}
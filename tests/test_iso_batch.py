@@ -0,0 +1,54 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from usb_session import UsbSession
+from usb_transaction import UsbTransaction
+
+# Must match XUD_ISO_BATCH_MAX
+BATCH_PKT_COUNT = 8
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed):
+
+    start_length = 10
+    end_length = start_length + BATCH_PKT_COUNT
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    # Whole batch received by XUD without client involvement
+    for pktLength in range(start_length, end_length):
+        session.add_event(
+            UsbTransaction(
+                session,
+                deviceAddress=address,
+                endpointNumber=ep,
+                endpointType="ISO",
+                transType="OUT",
+                dataLength=pktLength,
+                interEventDelay=500,
+            )
+        )
+
+    # Allow client time to check the batch and prepare the IN batch
+    interEventDelay = 4000
+
+    for pktLength in range(start_length, end_length):
+        session.add_event(
+            UsbTransaction(
+                session,
+                deviceAddress=address,
+                endpointNumber=ep,
+                endpointType="ISO",
+                transType="IN",
+                dataLength=pktLength,
+                interEventDelay=interEventDelay,
+            )
+        )
+        interEventDelay = 500
+
+    return session
@@ -0,0 +1,61 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from usb_packet import CreateSofToken
+from usb_session import UsbSession
+from usb_transaction import UsbTransaction
+
+# Must match XUD_ISO_BATCH_MAX, the DUT queues two batches of half this
+BATCH_PKT_COUNT = 8
+
+# Time for the DUT to finish both batches and ready a plain packet
+FINISH_DELAY = 4000
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed):
+
+    start_length = 10
+    end_length = start_length + BATCH_PKT_COUNT
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    frameNumber = 52
+
+    for transType in ["OUT", "IN"]:
+
+        # Both batches, then a SOF to tell the DUT to finish them
+        for pktLength in range(start_length, end_length):
+            session.add_event(
+                UsbTransaction(
+                    session,
+                    deviceAddress=address,
+                    endpointNumber=ep,
+                    endpointType="ISO",
+                    transType=transType,
+                    dataLength=pktLength,
+                    interEventDelay=FINISH_DELAY if pktLength == start_length else 500,
+                )
+            )
+
+        session.add_event(CreateSofToken(frameNumber, interEventDelay=500))
+        frameNumber += 1
+
+        # Plain packet after the late finish
+        session.add_event(
+            UsbTransaction(
+                session,
+                deviceAddress=address,
+                endpointNumber=ep,
+                endpointType="ISO",
+                transType=transType,
+                dataLength=end_length,
+                interEventDelay=FINISH_DELAY,
+            )
+        )
+
+    return session
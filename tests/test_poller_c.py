@@ -0,0 +1,12 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+from copy import deepcopy
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+
+# EP numbers currently fixed for this test - set in params
+PARAMS = deepcopy(PARAMS)
+for k in PARAMS:
+    PARAMS[k].update({"ep": [3]})
+
+from test_bulk_rx_multiep_select import test_session  # noqa F401
@@ -0,0 +1,110 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <stddef.h>
+#include "xud.h"
+#include "xud_poller.h"
+#include "test.h"
+#include "xud_shared.h"
+
+#define PACKET_LEN_START   (10)
+#define PACKET_LEN_END     (19)
+#define TEST_EP_COUNT      (3)
+#define PKT_COUNT          (PACKET_LEN_END - PACKET_LEN_START + 1)
+
+typedef struct
+{
+    unsigned char buffer[PKT_COUNT][512];
+    unsigned pktLength;
+    unsigned error;
+} TestEp_t;
+
+static int OutCallback(void *user, XUD_Result_t result, unsigned char **buffer, unsigned *length)
+{
+    TestEp_t *t = (TestEp_t *) user;
+    unsigned index = t->pktLength - PACKET_LEN_START;
+
+    if((result != XUD_RES_OKAY) || (*length != t->pktLength))
+    {
+        t->error = 1;
+        return 0;
+    }
+
+    t->pktLength++;
+
+    if(t->pktLength > PACKET_LEN_END)
+    {
+        return 0;
+    }
+
+    *buffer = t->buffer[index + 1];
+    return 1;
+}
+
+unsigned test_func(chanend c_ep_out[EP_COUNT_OUT], chanend c_ep_in[EP_COUNT_IN])
+{
+    TestEp_t testEps[TEST_EP_COUNT];
+    XUD_Poller_t poller;
+    unsigned exit = 0;
+
+    XUD_Poller_Init(&poller);
+
+    /* Control endpoint 0 must be refused */
+    if(XUD_Poller_Add(&poller, XUD_InitEp(c_ep_in[0]), 0, testEps[0].buffer[0], 0, OutCallback, &testEps[0]) >= 0)
+        return 1;
+
+    /* Register in reverse order with matching priorities to exercise priority sorting */
+    for(int i = TEST_EP_COUNT - 1; i >= 0; i--)
+    {
+        testEps[i].pktLength = PACKET_LEN_START;
+        testEps[i].error = 0;
+
+        XUD_ep ep = XUD_InitEp(c_ep_out[TEST_EP_NUM + i]);
+
+        if(XUD_Poller_Add(&poller, ep, i, testEps[i].buffer[0], 0, OutCallback, &testEps[i]) < 0)
+            return 1;
+    }
+
+    for(size_t i = 0; i < TEST_EP_COUNT; i++)
+    {
+        if(poller.eps[i].user != &testEps[i])
+            return 1;
+    }
+
+    while(!exit)
+    {
+        XUD_Poller_Poll(&poller);
+
+        exit = 1;
+        for(size_t i = 0; i < TEST_EP_COUNT; i++)
+        {
+            if(testEps[i].error)
+                return 1;
+
+            if(testEps[i].pktLength <= PACKET_LEN_END)
+                exit = 0;
+        }
+    }
+
+    for(size_t i = 0; i < TEST_EP_COUNT; i++)
+    {
+        unsigned length = PACKET_LEN_START;
+        unsigned char counter = 0;
+
+        for(size_t j = 0; j < PKT_COUNT; j++)
+        {
+            for(size_t k = 0; k < length; k++)
+            {
+                if(testEps[i].buffer[j][k] != counter)
+                {
+                    printstr("Mismatch:");
+                    printhexln(testEps[i].buffer[j][k]);
+                    return 1;
+                }
+                counter++;
+            }
+            length++;
+        }
+    }
+
+    return 0;
+}
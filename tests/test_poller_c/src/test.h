@@ -0,0 +1,4 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#define EP_COUNT_OUT       (7)
+#define EP_COUNT_IN        (7)
@@ -0,0 +1,52 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from usb_session import UsbSession
+from usb_transaction import UsbTransaction
+
+# Must match test source
+PKT_COUNT = 8
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed):
+
+    start_length = 10
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    # Data is forwarded to the other tile and back through the proxy in blocks
+    for pktLength in range(start_length, start_length + PKT_COUNT):
+        session.add_event(
+            UsbTransaction(
+                session,
+                deviceAddress=address,
+                endpointNumber=ep,
+                endpointType="BULK",
+                transType="OUT",
+                dataLength=pktLength,
+                interEventDelay=1000,
+            )
+        )
+
+    interEventDelay = 5000
+
+    for pktLength in range(start_length, start_length + PKT_COUNT):
+        session.add_event(
+            UsbTransaction(
+                session,
+                deviceAddress=address,
+                endpointNumber=ep,
+                endpointType="BULK",
+                transType="IN",
+                dataLength=pktLength,
+                interEventDelay=interEventDelay,
+            )
+        )
+        interEventDelay = 500
+
+    return session
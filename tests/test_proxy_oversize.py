@@ -0,0 +1,34 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from usb_session import UsbSession
+from usb_transaction import UsbTransaction
+
+# Must match test source
+PKT_LENGTH = 10
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed):
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    # The oversize packet sent by the remote is dropped by the proxy, only the
+    # packet that follows it reaches the host
+    session.add_event(
+        UsbTransaction(
+            session,
+            deviceAddress=address,
+            endpointNumber=ep,
+            endpointType="BULK",
+            transType="IN",
+            dataLength=PKT_LENGTH,
+            interEventDelay=5000,
+        )
+    )
+
+    return session
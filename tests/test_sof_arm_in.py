@@ -0,0 +1,68 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from usb_packet import CreateSofToken
+from usb_session import UsbSession
+from usb_transaction import UsbTransaction
+
+# Must match ARM_SOF_COUNT in test source
+ARM_SOF_COUNT = 2
+ARM_ROUNDS = 2
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed):
+
+    pktLength = 10
+    frameNumber = 52
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    # Trigger DUT to arm IN EP
+    session.add_event(
+        UsbTransaction(
+            session,
+            deviceAddress=address,
+            endpointNumber=ep,
+            endpointType="INTERRUPT",
+            transType="OUT",
+            dataLength=pktLength,
+        )
+    )
+
+    # Every round the EP must NAK until exactly ARM_SOF_COUNT SOFs have been
+    # received, regardless of when the DUT armed it
+    for _ in range(ARM_ROUNDS):
+        for sof in range(ARM_SOF_COUNT):
+            session.add_event(
+                UsbTransaction(
+                    session,
+                    deviceAddress=address,
+                    endpointNumber=ep,
+                    endpointType="INTERRUPT",
+                    transType="IN",
+                    dataLength=0,
+                    nacking=True,
+                    interEventDelay=2000,
+                )
+            )
+            session.add_event(CreateSofToken(frameNumber, interEventDelay=1000))
+            frameNumber += 1
+
+        session.add_event(
+            UsbTransaction(
+                session,
+                deviceAddress=address,
+                endpointNumber=ep,
+                endpointType="INTERRUPT",
+                transType="IN",
+                dataLength=pktLength,
+            )
+        )
+        pktLength += 1
+
+    return session
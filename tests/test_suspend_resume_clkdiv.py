@@ -0,0 +1,20 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from helpers import create_if_needed
+from test_suspend_resume_latency import resume_session
+
+# Suspend/resume with the tile clock divided whilst suspended. The DUT reads the
+# divider back during and after suspend, resume latency must stay within budget
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed, core_freq, dummy_threads):
+
+    report = "{}/suspend_resume_clkdiv_{}_{}_{}.json".format(
+        create_if_needed("logs"), core_freq, dummy_threads, bus_speed
+    )
+
+    return resume_session(ep, address, bus_speed, report)
@@ -0,0 +1,125 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import json
+import struct
+import sys
+
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from helpers import create_if_needed
+from usb_event import UsbEvent
+from usb_host import UsbHost, UsbTransferError
+from usb_packet import CreateSofToken
+from usb_signalling import UsbSuspend, UsbResume
+from usb_session import UsbSession
+from usb_transaction import UsbTransaction
+from usb_phy import USB_PKT_TIMINGS
+
+# Suspend/resume as test_suspend_resume, the DUT also measures the latency from
+# the resume K to the first ACKed transaction and returns it on its IN endpoint
+
+# Must match the report sent by the test source
+RESUME_STAGES = ["resume_end", "io_loop", "first_ack"]
+
+TICKS_PER_US = 100
+
+
+class UsbResumeReport(UsbEvent):
+    """Reads the resume latency measured by the DUT from its IN endpoint and
+    reports it. The report goes to a log file and stderr, so the expected
+    output is unchanged"""
+
+    def __init__(self, address, ep, report):
+        self._address = address
+        self._ep = ep
+        self._report = report
+        super().__init__()
+
+    @property
+    def event_count(self):
+        return 0
+
+    def expected_output(self, bus_speed, offset=0):
+        return ""
+
+    def drive(self, usb_phy, bus_speed):
+
+        host = UsbHost(usb_phy, bus_speed, address=self._address, quiet=True)
+
+        try:
+            data = host.run(host.in_transfer(self._ep, 4 * len(RESUME_STAGES)))
+        except UsbTransferError as e:
+            print("ERROR: Resume report failed with status {}".format(e.status))
+            return
+
+        ticks = struct.unpack("<{}I".format(len(RESUME_STAGES)), bytes(data))
+        latency_us = {s: t / TICKS_PER_US for s, t in zip(RESUME_STAGES, ticks)}
+
+        with open(self._report, "w") as f:
+            json.dump({"bus_speed": bus_speed, "latency_us": latency_us}, f, indent=4)
+
+        print(
+            "Resume latency ({}): ".format(bus_speed)
+            + ", ".join("{} {:.1f}us".format(s, t) for s, t in latency_us.items()),
+            file=sys.stderr,
+        )
+
+
+def resume_session(ep, address, bus_speed, report):
+
+    pktLength = 10
+    frameNumber = 52  # Note, for frame number 52 we expect A5 34 40 on the bus
+
+    interEventDelay = USB_PKT_TIMINGS["TX_TO_TX_PACKET_DELAY"]
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    session.add_event(
+        UsbTransaction(
+            session,
+            deviceAddress=address,
+            endpointNumber=ep,
+            endpointType="BULK",
+            transType="OUT",
+            dataLength=pktLength,
+            interEventDelay=0,
+        )
+    )
+
+    session.add_event(CreateSofToken(frameNumber))
+
+    session.add_event(UsbSuspend(350000))
+    session.add_event(UsbResume())
+
+    frameNumber = frameNumber + 1
+    pktLength = pktLength + 1
+    session.add_event(CreateSofToken(frameNumber, interEventDelay=2000))
+
+    session.add_event(
+        UsbTransaction(
+            session,
+            deviceAddress=address,
+            endpointNumber=ep,
+            endpointType="BULK",
+            transType="OUT",
+            dataLength=pktLength,
+            interEventDelay=interEventDelay,
+        )
+    )
+
+    session.add_event(UsbResumeReport(address, ep, report))
+
+    return session
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed, core_freq, dummy_threads):
+
+    report = "{}/suspend_resume_latency_{}_{}_{}.json".format(
+        create_if_needed("logs"), core_freq, dummy_threads, bus_speed
+    )
+
+    return resume_session(ep, address, bus_speed, report)
@@ -0,0 +1,34 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from usb_session import UsbSession
+from usb_transaction import UsbTransaction
+
+# Must match test Makefile
+PKT_LEN_START = 10
+PKT_LEN_END = 15
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed):
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    for transType in ["OUT", "IN"]:
+        for pktLength in range(PKT_LEN_START, PKT_LEN_END + 1):
+            session.add_event(
+                UsbTransaction(
+                    session,
+                    deviceAddress=address,
+                    endpointNumber=ep,
+                    endpointType="BULK",
+                    transType=transType,
+                    dataLength=pktLength,
+                )
+            )
+
+    return session
@@ -0,0 +1,114 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import json
+import struct
+
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from helpers import create_if_needed
+from usb_event import UsbEvent
+from usb_host import UsbHost, UsbTransferError
+from usb_session import UsbSession
+from usb_transaction import UsbTransaction
+
+# Must match test source
+PKT_LENGTH = 10
+PKT_COUNT = 16
+
+# Leave time for the DUT to drain the tap and re-arm between packets
+PKT_GAP_CLOCKS = 2000
+
+NS_PER_TICK = 10
+
+# Limit on the mean extra time per packet between XUD completing an OUT packet
+# and notifying the client when the packet is tapped
+MAX_TAP_OVERHEAD_NS = 500
+
+
+class UsbTapOverhead(UsbEvent):
+    """Reads back the notification times the DUT measured with the tap off and
+    on, reports them and checks the overhead of the tap"""
+
+    def __init__(self, address, ep, report):
+        self._address = address
+        self._ep = ep
+        self._report = report
+        super().__init__()
+
+    @property
+    def event_count(self):
+        return 0
+
+    def expected_output(self, bus_speed, offset=0):
+        return "Tap overhead checked\n"
+
+    def __str__(self):
+        return "UsbTapOverhead: EP {}".format(self._ep)
+
+    def drive(self, usb_phy, bus_speed):
+
+        host = UsbHost(usb_phy, bus_speed, address=self._address, quiet=True)
+
+        try:
+            data = host.run(host.in_transfer(self._ep, 8))
+        except UsbTransferError as e:
+            print("ERROR: Transfer failed with status {}".format(e.status))
+            return
+
+        ticksOff, ticksOn = struct.unpack("<2I", bytes(data))
+
+        # Half the packets are tapped
+        off_ns = ticksOff * NS_PER_TICK / (PKT_COUNT // 2)
+        on_ns = ticksOn * NS_PER_TICK / (PKT_COUNT // 2)
+
+        with open(self._report, "w") as f:
+            json.dump(
+                {
+                    "bus_speed": bus_speed,
+                    "notify_tap_off_ns": off_ns,
+                    "notify_tap_on_ns": on_ns,
+                    "overhead_ns": on_ns - off_ns,
+                },
+                f,
+                indent=4,
+            )
+
+        if on_ns - off_ns > MAX_TAP_OVERHEAD_NS:
+            print(
+                "ERROR: Tap overhead {:.0f}ns per packet, limit {}ns".format(
+                    on_ns - off_ns, MAX_TAP_OVERHEAD_NS
+                )
+            )
+
+        print("Tap overhead checked")
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed, core_freq, dummy_threads):
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    report = "{}/tap_overhead_{}_{}_{}.json".format(
+        create_if_needed("logs"), core_freq, dummy_threads, bus_speed
+    )
+
+    # DUT alternates the tap off and on for each packet
+    for _ in range(PKT_COUNT):
+        session.add_event(
+            UsbTransaction(
+                session,
+                deviceAddress=address,
+                endpointNumber=ep,
+                endpointType="BULK",
+                transType="OUT",
+                dataLength=PKT_LENGTH,
+                interEventDelay=PKT_GAP_CLOCKS,
+            )
+        )
+
+    session.add_event(UsbTapOverhead(address, ep, report))
+
+    return session
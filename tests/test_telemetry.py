@@ -0,0 +1,87 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import pytest
+
+from conftest import PARAMS, test_RunUsbSession  # noqa F401
+from usb_packet import (
+    CreateSofToken,
+    RxHandshakePacket,
+    TokenPacket,
+    TxDataPacket,
+    USB_PID,
+)
+from usb_session import UsbSession
+from usb_transaction import UsbTransaction
+
+# Must match test source
+PKT_LENGTH_START = 10
+SOF_GAP_CLOCKS = 3000
+SOF_COUNT = 4
+
+# Telemetry sampled alongside traffic the DUT ACKs and NAKs and a run of SOFs. The
+# DUT checks the per EP counts and SOF intervals it samples
+
+
+@pytest.fixture
+def test_session(ep, address, bus_speed):
+
+    frameNumber = 52
+
+    session = UsbSession(
+        bus_speed=bus_speed, run_enumeration=False, device_address=address
+    )
+
+    session.add_event(
+        UsbTransaction(
+            session,
+            deviceAddress=address,
+            endpointNumber=ep,
+            endpointType="BULK",
+            transType="OUT",
+            dataLength=PKT_LENGTH_START,
+        )
+    )
+
+    # Expect NAK's from DUT
+    session.add_event(
+        TokenPacket(
+            pid=USB_PID["IN"],
+            address=address,
+            endpoint=ep,
+        )
+    )
+    session.add_event(RxHandshakePacket(pid=USB_PID["NAK"]))
+
+    session.add_event(
+        TokenPacket(
+            pid=USB_PID["OUT"],
+            address=address,
+            endpoint=ep,
+            interEventDelay=500,
+        )
+    )
+    session.add_event(
+        TxDataPacket(
+            dataPayload=session.getPayload_out(ep, PKT_LENGTH_START + 1, resend=True),
+            pid=USB_PID["DATA1"],
+        )
+    )
+    session.add_event(RxHandshakePacket(pid=USB_PID["NAK"]))
+
+    # Evenly spaced SOFs, the first comes long after XUD started
+    for _ in range(SOF_COUNT):
+        session.add_event(CreateSofToken(frameNumber, interEventDelay=SOF_GAP_CLOCKS))
+        frameNumber += 1
+
+    session.add_event(
+        UsbTransaction(
+            session,
+            deviceAddress=address,
+            endpointNumber=ep,
+            endpointType="BULK",
+            transType="OUT",
+            dataLength=PKT_LENGTH_START + 1,
+        )
+    )
+
+    return session
@@ -43,6 +43,9 @@ class Clock(SimThread):
     def get_name(self):
         return self._name
 
+    def get_period_fs(self):
+        return self._period_fs
+
     def stop(self):
         print("**** CLOCK STOP ****")
         self._running = False
@@ -0,0 +1,238 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+""" Host enumeration model
+
+Performs the enumeration sequence a typical host issues to a newly attached
+device and reports the time taken by each request. Descriptors are parsed as
+they are read so the sequence follows whatever the DUT reports (string
+indices, configuration value etc). They can optionally be checked against
+the expected values.
+"""
+
+import json
+import struct
+
+from usb_event import UsbEvent
+from usb_host import (
+    USB_DESC_CONFIGURATION,
+    USB_DESC_DEVICE,
+    USB_DESC_STRING,
+    UsbHost,
+    UsbTransferError,
+)
+from usb_phy import USB_PKT_TIMINGS
+
+FS_PER_US = 1000 * 1000 * 1000
+
+# Spec: 2ms SET_ADDRESS recovery, shortened to keep simulation time reasonable
+SET_ADDRESS_RECOVERY_US = 20
+
+
+class UsbEnumeration(UsbEvent):
+    def __init__(
+        self,
+        device_address=1,
+        interTransactionDelay=USB_PKT_TIMINGS["TX_TO_TX_PACKET_DELAY"],
+        interRequestDelay=500,
+        setAddressRecovery_us=SET_ADDRESS_RECOVERY_US,
+        devDesc=None,
+        cfgDesc=None,
+        strings=None,
+        max_time_us=None,
+        report=None,
+    ):
+        self._address = device_address
+        self._interTransactionDelay = interTransactionDelay
+        self._interRequestDelay = interRequestDelay
+        self._setAddressRecovery_us = setAddressRecovery_us
+        self._expectedDevDesc = devDesc
+        self._expectedCfgDesc = cfgDesc
+        self._expectedStrings = strings
+        self._max_time_us = max_time_us
+        self._report = report
+        self._usb_phy = None
+        self._host = None
+
+        self.latency_us = []
+        self.total_time_us = None
+
+        super().__init__()
+
+    @property
+    def event_count(self):
+        return 0
+
+    def __str__(self):
+        return "UsbEnumeration: address " + str(self._address)
+
+    @staticmethod
+    def _requests(strings):
+        """Names of the requests reported, in order"""
+        names = [
+            "GET_DESCRIPTOR(DEVICE, 8)",
+            "SET_ADDRESS",
+            "GET_DESCRIPTOR(DEVICE)",
+            "GET_DESCRIPTOR(CONFIGURATION, 9)",
+            "GET_DESCRIPTOR(CONFIGURATION)",
+            "GET_DESCRIPTOR(STRING 0)",
+        ]
+        names += ["GET_DESCRIPTOR(STRING {})".format(i) for i in strings]
+        names.append("SET_CONFIGURATION")
+        return names
+
+    def expected_output(self, bus_speed, offset=0):
+        # String requests depend on the device descriptor so are only known
+        # up front when the expected descriptor is supplied
+        strings = []
+        if self._expectedDevDesc is not None:
+            strings = [i for i in self._expectedDevDesc[14:17] if i]
+
+        expected_output = ""
+        for name in self._requests(strings):
+            expected_output += "Enumeration: {}\n".format(name)
+        expected_output += "Enumeration complete\n"
+        return expected_output
+
+    def _request(self, name, fn, *args):
+        usb_phy = self._usb_phy
+
+        usb_phy.wait_for_clocks(self._interRequestDelay)
+
+        start = usb_phy.xsi.get_time()
+        result = fn(*args)
+        time_us = (usb_phy.xsi.get_time() - start) / FS_PER_US
+
+        self.latency_us.append((name, time_us))
+        print("Enumeration: {}".format(name))
+        return result
+
+    def _check(self, name, actual, expected):
+        if expected is not None and list(actual) != list(expected):
+            print("ERROR: {} mismatch".format(name))
+            print("Expected: {}".format(list(expected)))
+            print("Received: {}".format(list(actual)))
+
+    def _enumerate(self):
+        host = self._host
+        request = self._request
+
+        # Read the first 8 bytes of the device descriptor to learn the EP0 max
+        # packet size, then move the device to its address
+        host.maxPacketSize[0] = 8
+        desc = request(
+            "GET_DESCRIPTOR(DEVICE, 8)", host.get_descriptor, USB_DESC_DEVICE, 8
+        )
+        if len(desc) != 8 or desc[1] != USB_DESC_DEVICE:
+            print("ERROR: Bad device descriptor")
+            return False
+        host.maxPacketSize[0] = desc[7]
+
+        request("SET_ADDRESS", host.set_address, self._address)
+        self._usb_phy.wait_until(
+            self._usb_phy.xsi.get_time() + self._setAddressRecovery_us * FS_PER_US
+        )
+
+        devDesc = request(
+            "GET_DESCRIPTOR(DEVICE)", host.get_descriptor, USB_DESC_DEVICE, 18
+        )
+        self._check("Device descriptor", devDesc, self._expectedDevDesc)
+        if len(devDesc) != 18:
+            print("ERROR: Bad device descriptor")
+            return False
+
+        desc = request(
+            "GET_DESCRIPTOR(CONFIGURATION, 9)",
+            host.get_descriptor,
+            USB_DESC_CONFIGURATION,
+            9,
+        )
+        if len(desc) != 9 or desc[1] != USB_DESC_CONFIGURATION:
+            print("ERROR: Bad configuration descriptor")
+            return False
+        totalLength = struct.unpack_from("<H", desc, 2)[0]
+        configValue = desc[5]
+
+        cfgDesc = request(
+            "GET_DESCRIPTOR(CONFIGURATION)",
+            host.get_descriptor,
+            USB_DESC_CONFIGURATION,
+            totalLength,
+        )
+        self._check("Configuration descriptor", cfgDesc, self._expectedCfgDesc)
+        host.parse_config(cfgDesc)
+
+        desc = request(
+            "GET_DESCRIPTOR(STRING 0)", host.get_descriptor, USB_DESC_STRING, 255
+        )
+        if len(desc) < 4 or desc[1] != USB_DESC_STRING:
+            print("ERROR: Bad LangID string descriptor")
+            return False
+        langId = struct.unpack_from("<H", desc, 2)[0]
+
+        # iManufacturer, iProduct and iSerialNumber
+        for index in [i for i in devDesc[14:17] if i]:
+            desc = request(
+                "GET_DESCRIPTOR(STRING {})".format(index),
+                host.get_descriptor,
+                USB_DESC_STRING,
+                255,
+                index,
+                langId,
+            )
+            if self._expectedStrings is not None:
+                self._check(
+                    "String {}".format(index),
+                    desc[2:].decode("utf-16-le"),
+                    self._expectedStrings[index],
+                )
+
+        request("SET_CONFIGURATION", host.set_configuration, configValue)
+
+        return True
+
+    def drive(self, usb_phy, bus_speed):
+
+        self._usb_phy = usb_phy
+        self._host = UsbHost(
+            usb_phy,
+            bus_speed,
+            interTransactionDelay=self._interTransactionDelay,
+            quiet=True,
+        )
+
+        start = usb_phy.xsi.get_time()
+
+        try:
+            complete = self._enumerate()
+        except UsbTransferError as e:
+            print("ERROR: Enumeration failed with status {}".format(e.status))
+            complete = False
+
+        self.total_time_us = (usb_phy.xsi.get_time() - start) / FS_PER_US
+
+        if self._report is not None:
+            with open(self._report, "w") as f:
+                json.dump(
+                    {
+                        "bus_speed": bus_speed,
+                        "total_time_us": self.total_time_us,
+                        "requests": [
+                            {"request": name, "latency_us": latency}
+                            for name, latency in self.latency_us
+                        ],
+                    },
+                    f,
+                    indent=4,
+                )
+
+        if not complete:
+            return
+
+        if self._max_time_us is not None and self.total_time_us > self._max_time_us:
+            print(
+                "ERROR: Enumeration took {:.1f}us, limit {}us".format(
+                    self.total_time_us, self._max_time_us
+                )
+            )
+
+        print("Enumeration complete")
@@ -0,0 +1,295 @@
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+""" Host controller model
+
+Generates transactions on the simulated bus on demand, rather than from a
+pre-built event list. Transfers are generators that yield whilst the DUT is
+NAKing, so a caller can interleave several transfers or simply run one to
+completion with run().
+"""
+
+import contextlib
+import io
+import struct
+
+from usb_packet import (
+    USB_PID,
+    CreateSofToken,
+    RxPacket,
+    TokenPacket,
+    TxDataPacket,
+    TxHandshakePacket,
+)
+from usb_phy import USB_PKT_TIMINGS
+
+DIR_OUT = 0
+DIR_IN = 1
+
+EPIPE = 32
+EPROTO = 71
+
+USB_REQ_CLEAR_FEATURE = 0x01
+USB_REQ_SET_ADDRESS = 0x05
+USB_REQ_GET_DESCRIPTOR = 0x06
+USB_REQ_SET_CONFIGURATION = 0x09
+USB_REQ_SET_INTERFACE = 0x0B
+
+USB_DESC_DEVICE = 0x01
+USB_DESC_CONFIGURATION = 0x02
+USB_DESC_STRING = 0x03
+USB_DESC_INTERFACE = 0x04
+USB_DESC_ENDPOINT = 0x05
+
+USB_EP_TYPE_ISO = 0x01
+
+# Delay before retrying a NAKed transfer (USB clocks)
+NAK_RETRY_DELAY = 100
+
+
+class UsbTransferError(Exception):
+    def __init__(self, status):
+        super().__init__(status)
+        self.status = status
+
+
+class UsbHost:
+    def __init__(
+        self,
+        usb_phy,
+        bus_speed,
+        address=0,
+        interTransactionDelay=USB_PKT_TIMINGS["TX_TO_TX_PACKET_DELAY"],
+        quiet=False,
+    ):
+        self._usb_phy = usb_phy
+        self._bus_speed = bus_speed
+        self.address = address
+        self.interTransactionDelay = interTransactionDelay
+        self.responseTimeout = USB_PKT_TIMINGS["TX_TO_RX_PACKET_TIMEOUT"]
+        self.responseClocks = None
+        self.maxPacketSize = {0: 64}
+        self.epType = {}
+        self._dataPid = {}
+
+        # Packet level logging varies with the number of NAKs seen, so allow it
+        # to be suppressed when the output is compared against an expect file
+        self._quiet = quiet
+
+    def _log(self):
+        if self._quiet:
+            return contextlib.redirect_stdout(io.StringIO())
+        return contextlib.nullcontext()
+
+    # Bus transactions
+
+    def _send_token(self, pid, ep):
+        TokenPacket(
+            pid=USB_PID[pid],
+            address=self.address,
+            endpoint=ep,
+            interEventDelay=self.interTransactionDelay,
+        ).drive(self._usb_phy, self._bus_speed)
+
+    def _send_data(self, pid, data):
+        TxDataPacket(pid=pid, dataPayload=list(data), interEventDelay=0).drive(
+            self._usb_phy, self._bus_speed
+        )
+
+    def _send_ack(self):
+        TxHandshakePacket(interEventDelay=0).drive(self._usb_phy, self._bus_speed)
+
+    def _receive(self):
+        packet = RxPacket(timeout=self.responseTimeout)
+        rx = packet.receive(self._usb_phy, self._bus_speed)
+        self.responseClocks = packet.response_clocks
+        return rx
+
+    def sof(self, frameNumber):
+        with self._log():
+            CreateSofToken(frameNumber, interEventDelay=0).drive(
+                self._usb_phy, self._bus_speed
+            )
+
+    def _toggle(self, ep, direction):
+        key = (ep, direction)
+        if self.data_pid(ep, direction) == USB_PID["DATA0"]:
+            self._dataPid[key] = USB_PID["DATA1"]
+        else:
+            self._dataPid[key] = USB_PID["DATA0"]
+
+    def data_pid(self, ep, direction):
+        return self._dataPid.get((ep, direction), USB_PID["DATA0"])
+
+    def transaction_out(self, pid, ep, data_pid, data):
+        """OUT or SETUP transaction. Returns the handshake PID"""
+        with self._log():
+            self._send_token(pid, ep)
+            self._send_data(data_pid, data)
+            rx = self._receive()
+        if rx is None:
+            raise UsbTransferError(-EPROTO)
+        if rx[0] == USB_PID["STALL"]:
+            raise UsbTransferError(-EPIPE)
+        return rx[0]
+
+    def transaction_in(self, ep):
+        """IN transaction. Returns (data PID, payload) or (handshake PID, None)"""
+        with self._log():
+            self._send_token("IN", ep)
+            rx = self._receive()
+            if rx is None:
+                raise UsbTransferError(-EPROTO)
+            if rx[0] == USB_PID["STALL"]:
+                raise UsbTransferError(-EPIPE)
+            if rx[0] == USB_PID["NAK"]:
+                return (rx[0], None)
+
+            if self.epType.get(ep | 0x80) != USB_EP_TYPE_ISO:
+                self._send_ack()
+
+        # Strip PID and CRC16
+        return (rx[0], rx[1:-2])
+
+    def ping(self, ep):
+        """PING transaction. Returns the handshake PID"""
+        with self._log():
+            self._send_token("PING", ep)
+            rx = self._receive()
+        if rx is None:
+            raise UsbTransferError(-EPROTO)
+        if rx[0] == USB_PID["STALL"]:
+            raise UsbTransferError(-EPIPE)
+        return rx[0]
+
+    # Transfers
+
+    def in_transfer(self, ep, length):
+        mps = self.maxPacketSize.get(ep | 0x80, self.maxPacketSize[0])
+        data = []
+        while len(data) < length:
+            pid, payload = self.transaction_in(ep)
+            if payload is None:
+                yield
+                continue
+
+            # Repeated packet due to a lost ACK, discard
+            if pid != self.data_pid(ep, DIR_IN):
+                continue
+
+            self._toggle(ep, DIR_IN)
+            data += payload
+
+            if len(payload) < mps:
+                break
+
+        return data[:length]
+
+    def out_transfer(self, ep, data, zlp=False):
+        mps = self.maxPacketSize.get(ep, self.maxPacketSize[0])
+        offset = 0
+        while True:
+            chunk = data[offset : offset + mps]
+            pid = self.data_pid(ep, DIR_OUT)
+            if self.transaction_out("OUT", ep, pid, chunk) == USB_PID["NAK"]:
+                yield
+                continue
+
+            self._toggle(ep, DIR_OUT)
+            offset += len(chunk)
+
+            if offset >= len(data) and not (zlp and len(chunk) == mps):
+                break
+
+        return len(data)
+
+    def control_transfer(self, setup, data=b""):
+        bmRequestType, bRequest, wValue, wIndex, wLength = struct.unpack(
+            "<BBHHH", setup
+        )
+
+        nak = USB_PID["NAK"]
+        while self.transaction_out("SETUP", 0, USB_PID["DATA0"], setup) == nak:
+            yield
+
+        self._dataPid[(0, DIR_IN)] = USB_PID["DATA1"]
+        self._dataPid[(0, DIR_OUT)] = USB_PID["DATA1"]
+
+        result = []
+        if bmRequestType & 0x80:
+            if wLength:
+                result = yield from self.in_transfer(0, wLength)
+
+            # Status stage
+            while self.transaction_out("OUT", 0, USB_PID["DATA1"], []) == nak:
+                yield
+        else:
+            if wLength:
+                yield from self.out_transfer(0, list(data[:wLength]))
+
+            # Status stage
+            while True:
+                pid, payload = self.transaction_in(0)
+                if payload is not None:
+                    break
+                yield
+
+            self._update_state(bmRequestType, bRequest, wValue, wIndex)
+
+        return result
+
+    def _update_state(self, bmRequestType, bRequest, wValue, wIndex):
+        """Track data PID resets implied by standard requests"""
+        if bmRequestType == 0x00 and bRequest == USB_REQ_SET_CONFIGURATION:
+            for key in [k for k in self._dataPid if k[0] != 0]:
+                del self._dataPid[key]
+        elif bmRequestType == 0x01 and bRequest == USB_REQ_SET_INTERFACE:
+            for key in [k for k in self._dataPid if k[0] != 0]:
+                del self._dataPid[key]
+        elif bmRequestType == 0x02 and bRequest == USB_REQ_CLEAR_FEATURE:
+            direction = DIR_IN if wIndex & 0x80 else DIR_OUT
+            self._dataPid.pop((wIndex & 0xF, direction), None)
+
+    def run(self, transfer):
+        """Run a transfer to completion, backing off whilst NAKed"""
+        while True:
+            try:
+                next(transfer)
+            except StopIteration as done:
+                return done.value
+            self._usb_phy.wait_for_clocks(NAK_RETRY_DELAY)
+
+    # Standard requests
+
+    def get_descriptor(self, descType, length, index=0, langId=0):
+        setup = struct.pack(
+            "<BBHHH",
+            0x80,
+            USB_REQ_GET_DESCRIPTOR,
+            (descType << 8) | index,
+            langId,
+            length,
+        )
+        return bytes(self.run(self.control_transfer(setup)))
+
+    def set_address(self, address):
+        setup = struct.pack("<BBHHH", 0x00, USB_REQ_SET_ADDRESS, address, 0, 0)
+        self.run(self.control_transfer(setup))
+        self.address = address
+
+    def set_configuration(self, value):
+        setup = struct.pack("<BBHHH", 0x00, USB_REQ_SET_CONFIGURATION, value, 0, 0)
+        self.run(self.control_transfer(setup))
+
+    def parse_config(self, cfgDesc):
+        """Record endpoint max packet sizes and types from a config descriptor"""
+        offset = 0
+        while offset + 1 < len(cfgDesc):
+            bLength = cfgDesc[offset]
+            if bLength == 0:
+                break
+            if cfgDesc[offset + 1] == USB_DESC_ENDPOINT:
+                epAddr = cfgDesc[offset + 2]
+                mps = struct.unpack_from("<H", cfgDesc, offset + 4)[0]
+                self.maxPacketSize[epAddr] = mps & 0x7FF
+                self.epType[epAddr] = cfgDesc[offset + 3] & 0x3
+            offset += bLength
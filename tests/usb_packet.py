@@ -113,16 +113,27 @@ def CreateSofToken(
     )
 
 
-def GenCrc16(data: bytes):
+def _GenCrc16Table():
     poly = 0xA001
-    crc = 0xFFFF
-    for b in data:
-        crc ^= 0xFF & b
+    table = []
+    for b in range(0, 256):
+        crc = b
         for _ in range(0, 8):
             if crc & 0x0001:
                 crc = (crc >> 1) ^ poly
             else:
                 crc >>= 1
+        table.append(crc)
+    return table
+
+
+_CRC16_TABLE = _GenCrc16Table()
+
+
+def GenCrc16(data: bytes):
+    crc = 0xFFFF
+    for b in data:
+        crc = (crc >> 8) ^ _CRC16_TABLE[(crc ^ b) & 0xFF]
 
     return crc ^ 0xFFFF
 
@@ -233,7 +244,8 @@ class RxPacket(UsbPacket):
 
         return expected_output
 
-    def drive(self, usb_phy, bus_speed):
+    def receive(self, usb_phy, bus_speed):
+        """Capture the next packet from the DUT. Returns None on timeout"""
 
         wait = usb_phy.wait
         xsi = usb_phy.xsi
@@ -255,37 +267,49 @@ class RxPacket(UsbPacket):
                 in_rx_packet = True
                 break
 
+        # DUT turnaround time in USB clocks
+        self.response_clocks = self.timeout - timeout
+
         txrdy_pulse = USB_DATA_VALID_COUNT[bus_speed] - 1
 
         if not in_rx_packet:
-            print("ERROR: Timed out waiting for packet")
-        else:
-            while in_rx_packet:
+            return None
 
-                # Tx Rdy pulsing
-                for i in range(txrdy_pulse):
-                    wait(lambda x: usb_phy._clock.is_high())
-                    wait(lambda x: usb_phy._clock.is_low())
-
-                xsi.drive_port_pins(usb_phy._txrdy, 1)
-                data = xsi.sample_port_pins(usb_phy._txd)
-
-                print("\tRX byte: {0:#x}".format(data))
-                rx_packet.append(data)
+        while in_rx_packet:
 
+            # Tx Rdy pulsing
+            for i in range(txrdy_pulse):
                 wait(lambda x: usb_phy._clock.is_high())
                 wait(lambda x: usb_phy._clock.is_low())
 
-                # Note, for HS this will be set high again before another clock
-                xsi.drive_port_pins(usb_phy._txrdy, 0)
+            xsi.drive_port_pins(usb_phy._txrdy, 1)
+            data = xsi.sample_port_pins(usb_phy._txd)
 
-                if xsi.sample_port_pins(usb_phy._txv) == 0:
-                    # TxV low, break out of loop
-                    in_rx_packet = False
+            print("\tRX byte: {0:#x}".format(data))
+            rx_packet.append(data)
 
-            # End of packet
+            wait(lambda x: usb_phy._clock.is_high())
+            wait(lambda x: usb_phy._clock.is_low())
+
+            # Note, for HS this will be set high again before another clock
             xsi.drive_port_pins(usb_phy._txrdy, 0)
 
+            if xsi.sample_port_pins(usb_phy._txv) == 0:
+                # TxV low, break out of loop
+                in_rx_packet = False
+
+        # End of packet
+        xsi.drive_port_pins(usb_phy._txrdy, 0)
+
+        return rx_packet
+
+    def drive(self, usb_phy, bus_speed):
+
+        rx_packet = self.receive(usb_phy, bus_speed)
+
+        if rx_packet is None:
+            print("ERROR: Timed out waiting for packet")
+        else:
             # Check packet against expected
             expected = self.get_bytes()
             if len(expected) != len(rx_packet):
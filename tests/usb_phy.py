@@ -174,6 +174,17 @@ class UsbPhy(Pyxsim.SimThread):
     def wait_for_clocks(self, clockCount):
 
         delay = clockCount
+
+        # Skip over long delays in a single step rather than polling every
+        # clock edge. Having synced to a falling edge, land a quarter period
+        # before the last falling edge and let the final wait consume it.
+        if delay > 2:
+            period = self._clock.get_period_fs()
+            self.wait(lambda x: self._clock.is_high())
+            self.wait(lambda x: self._clock.is_low())
+            self.wait_until(self.xsi.get_time() + delay * period - (period // 4))
+            delay = 0
+
         while delay >= 0:
             self.wait(lambda x: self._clock.is_high())
             self.wait(lambda x: self._clock.is_low())
@@ -2,6 +2,7 @@
 # This Software is subject to the terms of the XMOS Public Licence: Version 1.
 
 from usb_packet import USB_DATA_VALID_COUNT
+from usb_enumeration import UsbEnumeration
 import usb_packet
 
 # TODO should EP numbers include the IN bit?
@@ -21,6 +22,7 @@ class UsbSession:
         run_enumeration=False,
         device_address=0,
         initial_delay=None,
+        enumeration=None,
     ):
         self._initial_delay = initial_delay
         self._bus_speed = bus_speed
@@ -33,7 +35,11 @@ class UsbSession:
         self._dataGen_in = [0] * 16
         self._dataGen_out = [0] * 16
 
-        assert run_enumeration is False, "Not yet supported"
+        # Enumerate the DUT to device_address before any other events
+        if run_enumeration:
+            if enumeration is None:
+                enumeration = UsbEnumeration(device_address=device_address)
+            self.add_event(enumeration)
 
     @property
     def initial_delay(self):
@@ -0,0 +1,412 @@
+#!/usr/bin/env python
+# Copyright 2023 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+""" USB/IP bridge to a simulated device
+
+Exposes the DUT running under xsim to the local host USB stack as a USB/IP
+server. The simulated PHY acts as the host controller: URBs received from
+vhci-hcd are turned into bus transactions on the simulated UTMI interface and
+the results returned to the kernel. Unmodified libusb host tools can then
+enumerate and stream from simulated firmware, for example:
+
+    python usbip_bridge.py app.xe --attach
+    sudo usbip attach -r localhost -b 1-1
+
+Control, bulk and interrupt endpoints are supported. Note, vhci-hcd handles
+SET_ADDRESS and port resets itself so the DUT stays at the session address.
+
+Whilst a client is attached an SOF is sent at the start of every (micro)frame,
+including whilst the bus is otherwise idle, as a host controller would.
+"""
+
+import argparse
+import select
+import socket
+import struct
+
+import Pyxsim
+from helpers import get_usb_clk_phy
+from usb_event import UsbEvent
+from usb_host import (
+    USB_DESC_CONFIGURATION,
+    USB_DESC_DEVICE,
+    USB_DESC_INTERFACE,
+    NAK_RETRY_DELAY,
+    UsbHost,
+    UsbTransferError,
+)
+from usb_session import UsbSession
+from usb_signalling import UsbDeviceAttach
+
+USBIP_PORT = 3240
+USBIP_VERSION = 0x0111
+
+OP_REQ_DEVLIST = 0x8005
+OP_REP_DEVLIST = 0x0005
+OP_REQ_IMPORT = 0x8003
+OP_REP_IMPORT = 0x0003
+
+USBIP_CMD_SUBMIT = 0x0001
+USBIP_CMD_UNLINK = 0x0002
+USBIP_RET_SUBMIT = 0x0003
+USBIP_RET_UNLINK = 0x0004
+
+USBIP_DIR_OUT = 0
+USBIP_DIR_IN = 1
+
+URB_ZERO_PACKET = 0x0040
+
+USBIP_SPEED = {"FS": 2, "HS": 3}
+
+FS_PER_US = 1000 * 1000 * 1000
+FRAME_TIME_US = {"HS": 125, "FS": 1000}
+
+# (Micro)frames per frame number
+FRAME_NUMBER_DIV = {"HS": 8, "FS": 1}
+
+EOPNOTSUPP = 95
+ECONNRESET = 104
+
+
+class UsbIpUrb:
+    def __init__(self, seqnum, ep, direction, flags, length, setup, data):
+        self.seqnum = seqnum
+        self.ep = ep
+        self.direction = direction
+        self.flags = flags
+        self.length = length
+        self.setup = setup
+        self.data = data
+        self.transfer = None
+
+
+class UsbIpBridge(UsbEvent):
+    """Session event that services a USB/IP client until it disconnects"""
+
+    def __init__(self, port=USBIP_PORT, busid="1-1", device_address=0, verbose=False):
+        self._port = port
+        self._busid = busid.encode()
+        self._address = device_address
+        self._verbose = verbose
+
+        self._usb_phy = None
+        self._bus_speed = None
+        self._host = None
+        self._devDesc = None
+        self._cfgDesc = None
+
+        self._frame = 0
+        self._nextSof = None
+
+        super().__init__()
+
+    @property
+    def event_count(self):
+        return 0
+
+    def expected_output(self, bus_speed, offset=0):
+        return ""
+
+    def __str__(self):
+        return "UsbIpBridge: port " + str(self._port)
+
+    def drive(self, usb_phy, bus_speed):
+
+        self._usb_phy = usb_phy
+        self._bus_speed = bus_speed
+        self._host = UsbHost(
+            usb_phy, bus_speed, address=self._address, quiet=not self._verbose
+        )
+
+        self._read_descriptors()
+
+        server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        server.bind(("", self._port))
+        server.listen(1)
+        print("USB/IP: listening on port {}".format(self._port))
+
+        # Note, simulation is paused whilst waiting for a client
+        while True:
+            conn, _ = server.accept()
+            conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            imported = self._handle_op(conn)
+            if imported:
+                self._serve_urbs(conn)
+                conn.close()
+                break
+            conn.close()
+
+        server.close()
+
+    def _urb_transfer(self, urb):
+        if urb.ep == 0:
+            result = yield from self._host.control_transfer(urb.setup, urb.data)
+        elif urb.direction == USBIP_DIR_IN:
+            result = yield from self._host.in_transfer(urb.ep, urb.length)
+        else:
+            zlp = (urb.flags & URB_ZERO_PACKET) != 0
+            result = yield from self._host.out_transfer(urb.ep, list(urb.data), zlp)
+        return result
+
+    def _read_descriptors(self):
+        host = self._host
+
+        # Read the first 8 bytes to learn the EP0 max packet size
+        host.maxPacketSize[0] = 8
+        desc = host.get_descriptor(USB_DESC_DEVICE, 8)
+        host.maxPacketSize[0] = desc[7]
+
+        self._devDesc = host.get_descriptor(USB_DESC_DEVICE, 18)
+
+        desc = host.get_descriptor(USB_DESC_CONFIGURATION, 9)
+        totalLength = struct.unpack_from("<H", desc, 2)[0]
+        self._cfgDesc = host.get_descriptor(USB_DESC_CONFIGURATION, totalLength)
+        host.parse_config(self._cfgDesc)
+
+    # USB/IP protocol
+
+    def _interfaces(self):
+        intfs = []
+        offset = 0
+        while offset + 1 < len(self._cfgDesc):
+            bLength = self._cfgDesc[offset]
+            if bLength == 0:
+                break
+            # Alternate setting 0 only
+            if (
+                self._cfgDesc[offset + 1] == USB_DESC_INTERFACE
+                and self._cfgDesc[offset + 3] == 0
+            ):
+                intfs.append(tuple(self._cfgDesc[offset + 5 : offset + 8]))
+            offset += bLength
+        return intfs
+
+    def _device_record(self):
+        d = self._devDesc
+        path = "/sys/devices/xsim/usb1/" + self._busid.decode()
+        idVendor, idProduct, bcdDevice = struct.unpack_from("<HHH", d, 8)
+        return struct.pack(
+            ">256s32sIIIHHHBBBBBB",
+            path.encode(),
+            self._busid,
+            1,  # busnum
+            2,  # devnum
+            USBIP_SPEED[self._bus_speed],
+            idVendor,
+            idProduct,
+            bcdDevice,
+            d[4],  # bDeviceClass
+            d[5],  # bDeviceSubClass
+            d[6],  # bDeviceProtocol
+            0,  # bConfigurationValue
+            d[17],  # bNumConfigurations
+            len(self._interfaces()),
+        )
+
+    def _handle_op(self, conn):
+        """Handle a device list or import request. Returns True on import"""
+        version, code, _ = struct.unpack(">HHI", _recv_exact(conn, 8))
+
+        if code == OP_REQ_DEVLIST:
+            reply = struct.pack(">HHII", USBIP_VERSION, OP_REP_DEVLIST, 0, 1)
+            reply += self._device_record()
+            for intf in self._interfaces():
+                reply += struct.pack(">BBBB", intf[0], intf[1], intf[2], 0)
+            conn.sendall(reply)
+            return False
+
+        if code == OP_REQ_IMPORT:
+            busid = _recv_exact(conn, 32).rstrip(b"\0")
+            if busid != self._busid:
+                conn.sendall(struct.pack(">HHI", USBIP_VERSION, OP_REP_IMPORT, 1))
+                return False
+            reply = struct.pack(">HHI", USBIP_VERSION, OP_REP_IMPORT, 0)
+            reply += self._device_record()
+            conn.sendall(reply)
+            print("USB/IP: device imported")
+            return True
+
+        print("USB/IP: unsupported op {:#x}".format(code))
+        return False
+
+    def _recv_urb(self, conn, pending):
+        """Read one command. Returns False once the client has disconnected"""
+        header = _recv_exact(conn, 48)
+        if header is None:
+            return False
+
+        command, seqnum, _, direction, ep = struct.unpack_from(">IIIII", header)
+
+        if command == USBIP_CMD_UNLINK:
+            unlink_seqnum = struct.unpack_from(">I", header, 20)[0]
+            status = 0
+            for urb in pending:
+                if urb.seqnum == unlink_seqnum:
+                    pending.remove(urb)
+                    status = -ECONNRESET
+                    break
+            conn.sendall(
+                struct.pack(">IIIIIi24x", USBIP_RET_UNLINK, seqnum, 0, 0, 0, status)
+            )
+            return True
+
+        flags, length, _, numPackets, _ = struct.unpack_from(">IIiiI", header, 20)
+        setup = header[40:48]
+
+        data = b""
+        if direction == USBIP_DIR_OUT and length:
+            data = _recv_exact(conn, length)
+            if data is None:
+                return False
+
+        urb = UsbIpUrb(seqnum, ep, direction, flags, length, setup, data)
+
+        # Isochronous URBs carry per packet descriptors, these are not supported
+        if numPackets not in (0, -1):
+            if _recv_exact(conn, 16 * numPackets) is None:
+                return False
+            self._complete(conn, urb, -EOPNOTSUPP, b"")
+            return True
+
+        urb.transfer = self._urb_transfer(urb)
+        pending.append(urb)
+        return True
+
+    def _complete(self, conn, urb, status, data):
+        if urb.direction == USBIP_DIR_IN:
+            actual = len(data)
+        else:
+            actual = urb.length if status == 0 else 0
+            data = b""
+
+        if self._verbose:
+            print(
+                "USB/IP: seq {} ep {} status {} length {}".format(
+                    urb.seqnum, urb.ep, status, actual
+                )
+            )
+
+        conn.sendall(
+            struct.pack(
+                ">IIIIIiIiII8x",
+                USBIP_RET_SUBMIT,
+                urb.seqnum,
+                0,
+                0,
+                0,
+                status,
+                actual,
+                0,
+                0,
+                0,
+            )
+            + bytes(data)
+        )
+
+    def _sof(self):
+        """Send an SOF if a (micro)frame boundary has been reached"""
+        if self._usb_phy.xsi.get_time() < self._nextSof:
+            return
+
+        frameNumber = (self._frame // FRAME_NUMBER_DIV[self._bus_speed]) & 0x7FF
+        self._host.sof(frameNumber)
+        self._frame += 1
+        self._nextSof += FRAME_TIME_US[self._bus_speed] * FS_PER_US
+
+    def _serve_urbs(self, conn):
+        pending = []
+
+        self._nextSof = self._usb_phy.xsi.get_time()
+        self._sof()
+
+        while True:
+            readable, _, _ = select.select([conn], [], [], 0)
+            if readable:
+                if not self._recv_urb(conn, pending):
+                    print("USB/IP: client disconnected")
+                    return
+                continue
+
+            # Keep the bus alive with SOFs whilst there is nothing to do
+            if not pending:
+                self._usb_phy.wait_until(self._nextSof)
+                self._sof()
+                continue
+
+            # Service each pending URB once, completed URBs are removed
+            progressed = False
+            for urb in list(pending):
+                self._sof()
+                try:
+                    next(urb.transfer)
+                except StopIteration as done:
+                    pending.remove(urb)
+                    result = done.value
+                    data = bytes(result) if urb.direction == USBIP_DIR_IN else b""
+                    self._complete(conn, urb, 0, data)
+                    progressed = True
+                except UsbTransferError as e:
+                    pending.remove(urb)
+                    self._complete(conn, urb, e.status, b"")
+                    progressed = True
+
+            if not progressed:
+                self._usb_phy.wait_for_clocks(NAK_RETRY_DELAY)
+                self._sof()
+
+
+def _recv_exact(conn, length):
+    data = b""
+    while len(data) < length:
+        chunk = conn.recv(length - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return data
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="USB/IP bridge to a simulated XUD device"
+    )
+    parser.add_argument("binary", help="Application xe to simulate")
+    parser.add_argument("--port", type=int, default=USBIP_PORT)
+    parser.add_argument("--busid", default="1-1")
+    parser.add_argument("--bus-speed", choices=["HS", "FS"], default="HS")
+    parser.add_argument("--address", type=int, default=0)
+    parser.add_argument(
+        "--attach",
+        action="store_true",
+        help="Run device attach signalling first (app built without XUD_BYPASS_RESET)",
+    )
+    parser.add_argument("--verbose", action="store_true")
+    args = parser.parse_args()
+
+    (clk, phy) = get_usb_clk_phy(verbose=args.verbose, do_timeout=False, arch="xs3")
+
+    session = UsbSession(
+        bus_speed=args.bus_speed,
+        run_enumeration=False,
+        device_address=args.address,
+        initial_delay=22000 * 1000 * 1000 if args.attach else None,  # fS
+    )
+
+    if args.attach:
+        session.add_event(UsbDeviceAttach())
+
+    session.add_event(
+        UsbIpBridge(
+            port=args.port,
+            busid=args.busid,
+            device_address=args.address,
+            verbose=args.verbose,
+        )
+    )
+
+    phy.session = session
+    Pyxsim.run_on_simulator_(args.binary, simthreads=[clk, phy], simargs=[])
+
+
+if __name__ == "__main__":
+    main()